@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+
+#include "bench_common.hpp"
+
+static void BM_CheckCollisionAABB(benchmark::State &state)
+{
+  Game game(SCREEN_WIDTH, SCREEN_HEIGHT);
+  GameObject one(glm::vec2(100.0f, 100.0f), glm::vec2(60.0f, 20.0f), Texture2D());
+  GameObject two(glm::vec2(130.0f, 110.0f), glm::vec2(100.0f, 20.0f), Texture2D());
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(game.CheckCollision(one, two));
+    two.Position.x += 0.001f;
+  }
+}
+BENCHMARK(BM_CheckCollisionAABB);
+
+static void BM_CheckCollisionBall(benchmark::State &state)
+{
+  Game game(SCREEN_WIDTH, SCREEN_HEIGHT);
+  // range(0) selects a ball that is overlapping the block (1) or clear of it (0)
+  float ballY = state.range(0) ? 115.0f : 300.0f;
+  BallObject ball(glm::vec2(120.0f, ballY), 12.5f, glm::vec2(100.0f, -350.0f), Texture2D());
+  GameObject block(glm::vec2(100.0f, 100.0f), glm::vec2(53.3f, 37.5f), Texture2D());
+  for (auto _ : state)
+  {
+    Collision collision = game.CheckCollision(ball, block);
+    benchmark::DoNotOptimize(collision);
+  }
+}
+BENCHMARK(BM_CheckCollisionBall)->Arg(0)->Arg(1);
+
+static void BM_VectorDirection(benchmark::State &state)
+{
+  Game game(SCREEN_WIDTH, SCREEN_HEIGHT);
+  glm::vec2 target(0.3f, -0.7f);
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(game.VectorDirection(target));
+    target.x = -target.x;
+  }
+}
+BENCHMARK(BM_VectorDirection);
+
+static void BM_DoCollisions(benchmark::State &state)
+{
+  Game game(SCREEN_WIDTH, SCREEN_HEIGHT);
+  InitDenseGame(game, state.range(0), state.range(0) / 2);
+  for (auto _ : state)
+    game.DoCollisions();
+  state.counters["bricks"] = game.Levels[game.CurrentLevel].Bricks().size();
+  state.SetItemsProcessed(state.iterations() * game.Levels[game.CurrentLevel].Bricks().size());
+}
+BENCHMARK(BM_DoCollisions)->Arg(16)->Arg(64)->Arg(256)->Arg(1024);
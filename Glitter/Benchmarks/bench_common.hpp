@@ -0,0 +1,56 @@
+#ifndef BENCH_COMMON_HPP
+#define BENCH_COMMON_HPP
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "game.hpp"
+
+// Path of a file the benchmarks generate, in the system's temporary directory
+inline std::string BenchTempPath(const std::string &name)
+{
+#ifdef _WIN32
+  const char *directory = std::getenv("TEMP");
+  const char *fallback = ".";
+#else
+  const char *directory = std::getenv("TMPDIR");
+  const char *fallback = "/tmp";
+#endif
+  return std::string(directory && *directory ? directory : fallback) + "/" + name;
+}
+
+// Writes a generated text level of width x height tiles to the temporary directory. Every tile
+// is filled so the level is as dense as possible; every 7th tile is solid, the rest cycle
+// through the colours.
+inline std::string WriteLevelFile(unsigned int width, unsigned int height)
+{
+  std::ostringstream name;
+  name << "bench_" << width << "x" << height << ".lvl";
+  std::string path = BenchTempPath(name.str());
+  std::ofstream file(path.c_str());
+  for (unsigned int y = 0; y < height; ++y)
+  {
+    for (unsigned int x = 0; x < width; ++x)
+    {
+      unsigned int index = y * width + x;
+      file << (index % 7 == 0 ? 1 : 2 + index % 4);
+      file << (x + 1 < width ? ' ' : '\n');
+    }
+  }
+  return path;
+}
+
+// Game running without a GL context whose current level is a generated width x height level
+// spanning the upper half of the screen, the ball stays stuck to the paddle below it.
+inline void InitDenseGame(Game &game, unsigned int width, unsigned int height)
+{
+  game.InitHeadless();
+  GameLevel dense;
+  dense.Load(WriteLevelFile(width, height).c_str(), game.Width, game.Height / 2);
+  game.Levels.push_back(dense);
+  game.CurrentLevel = game.Levels.size() - 1;
+}
+
+#endif // BENCH_COMMON_HPP
@@ -0,0 +1,116 @@
+#include <benchmark/benchmark.h>
+
+#include "bench_common.hpp"
+#include "level_format.hpp"
+#include "mapped_file.hpp"
+#include "resource_manager.hpp"
+#include "stb_image.h"
+#include "texture_cache.hpp"
+
+static void BM_GameLevelLoad(benchmark::State &state)
+{
+  std::string file = WriteLevelFile(state.range(0), state.range(0));
+  GameLevel level;
+  for (auto _ : state)
+  {
+    level.Load(file.c_str(), SCREEN_WIDTH, SCREEN_HEIGHT / 2);
+    benchmark::DoNotOptimize(level.Bricks().data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+BENCHMARK(BM_GameLevelLoad)->Arg(15)->Arg(256)->Arg(1024)->Unit(benchmark::kMillisecond);
+
+// registers the same names Game::Init does, without uploading anything
+static void RegisterGameResources()
+{
+  const char *textures[] = {"background", "face", "block", "block_solid", "paddle", "particle",
+                            "tex_chaos", "tex_confuse", "tex_increase", "tex_pass", "tex_speed", "tex_sticky"};
+  for (const char *name : textures)
+    ResourceManager::GetTextureHandle(name);
+  ResourceManager::GetShaderHandle("sprite");
+  ResourceManager::GetShaderHandle("particle");
+  ResourceManager::GetShaderHandle("effects");
+}
+
+static void BM_GetTexture(benchmark::State &state)
+{
+  RegisterGameResources();
+  for (auto _ : state)
+    benchmark::DoNotOptimize(ResourceManager::GetTexture("background").ID);
+}
+BENCHMARK(BM_GetTexture);
+
+static void BM_GetShader(benchmark::State &state)
+{
+  RegisterGameResources();
+  for (auto _ : state)
+    benchmark::DoNotOptimize(ResourceManager::GetShader("sprite").ID);
+}
+BENCHMARK(BM_GetShader);
+
+// the frame loop's path: handles resolved once, then an array index per lookup
+static void BM_GetTextureHandle(benchmark::State &state)
+{
+  RegisterGameResources();
+  TextureHandle background = ResourceManager::GetTextureHandle(HashName("background"));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(ResourceManager::GetTexture(background).ID);
+}
+BENCHMARK(BM_GetTextureHandle);
+
+static void BM_GameLevelLoadCompiled(benchmark::State &state)
+{
+  std::string file = WriteLevelFile(state.range(0), state.range(0));
+  MappedFile text;
+  LevelTiles tiles;
+  text.Open(file.c_str());
+  ParseLevelText(reinterpret_cast<const char *>(text.Data()), text.Size(), tiles);
+  std::string compiled = file.substr(0, file.size() - 4) + ".blvl";
+  WriteCompiledLevel(compiled.c_str(), tiles);
+
+  GameLevel level;
+  for (auto _ : state)
+  {
+    level.Load(compiled.c_str(), SCREEN_WIDTH, SCREEN_HEIGHT / 2);
+    benchmark::DoNotOptimize(level.Bricks().data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+BENCHMARK(BM_GameLevelLoadCompiled)->Arg(15)->Arg(256)->Arg(1024)->Unit(benchmark::kMillisecond);
+
+// decoding the background JPEG, what every launch paid before the texture cache
+static void BM_TextureDecode(benchmark::State &state)
+{
+  std::string file = ResourceManager::AssetRoot + "/Textures/background.jpg";
+  for (auto _ : state)
+  {
+    int width, height, nrChannels;
+    unsigned char *data = stbi_load(file.c_str(), &width, &height, &nrChannels, 0);
+    benchmark::DoNotOptimize(data);
+    stbi_image_free(data);
+  }
+}
+BENCHMARK(BM_TextureDecode)->Unit(benchmark::kMillisecond);
+
+// mapping the same image's texels from the texture cache, touching every page like the upload does
+static void BM_TextureCacheLoad(benchmark::State &state)
+{
+  std::string file = ResourceManager::AssetRoot + "/Textures/background.jpg";
+  TextureCache::Enable(BenchTempPath("bench_texture_cache"));
+  int width, height, nrChannels;
+  unsigned char *data = stbi_load(file.c_str(), &width, &height, &nrChannels, 0);
+  TextureCache::Store(file, width, height, nrChannels, data);
+  stbi_image_free(data);
+  for (auto _ : state)
+  {
+    MappedFile entry;
+    const TextureCacheHeader *header = TextureCache::Load(file, entry);
+    unsigned int sum = 0;
+    for (size_t i = sizeof(TextureCacheHeader); i < entry.Size(); i += 4096)
+      sum += entry.Data()[i];
+    benchmark::DoNotOptimize(header);
+    benchmark::DoNotOptimize(sum);
+  }
+  TextureCache::Directory.clear();
+}
+BENCHMARK(BM_TextureCacheLoad)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,116 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "vec_env.hpp"
+
+static void BM_ParticleUpdate(benchmark::State &state)
+{
+  Random random;
+  ParticleGenerator particles(Shader(), Texture2D(), state.range(0), random);
+  GameObject object(glm::vec2(400.0f, 300.0f), glm::vec2(25.0f), Texture2D(),
+                    glm::vec3(1.0f), glm::vec2(100.0f, -350.0f));
+  for (auto _ : state)
+    particles.Update(1.0f / 60.0f, object, 2, glm::vec2(6.25f));
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ParticleUpdate)->Arg(500)->Arg(5000)->Arg(50000);
+
+// range(0) activated power-ups out of play, every 16th running out this tick: those are
+// deactivated (looking for another active one of their type) and erased, the rest tick down
+static void BM_UpdatePowerUps(benchmark::State &state)
+{
+  Game game(SCREEN_WIDTH, SCREEN_HEIGHT);
+  game.InitHeadless();
+  std::vector<PowerUp> seeded;
+  for (int i = 0; i < state.range(0); ++i)
+  {
+    float duration = i % 16 == 0 ? 0.01f : 10.0f;
+    PowerUp powerUp(static_cast<PowerUpType>(i % POWER_UP_TYPES), glm::vec3(1.0f), duration, glm::vec2(i % SCREEN_WIDTH, 0.0f), Texture2D());
+    powerUp.Activated = true;
+    powerUp.Destroyed = true;
+    seeded.push_back(powerUp);
+  }
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    game.PowerUps = seeded;
+    state.ResumeTiming();
+    game.UpdatePowerUps(1.0f / 60.0f);
+  }
+  state.counters["expired"] = static_cast<double>(seeded.size() - game.PowerUps.size());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_UpdatePowerUps)->Arg(16)->Arg(256)->Arg(4096);
+
+static void BM_Rand(benchmark::State &state)
+{
+  for (auto _ : state)
+    benchmark::DoNotOptimize(rand());
+}
+BENCHMARK(BM_Rand);
+
+static void BM_RandomNext(benchmark::State &state)
+{
+  Random random;
+  for (auto _ : state)
+    benchmark::DoNotOptimize(random.Next());
+}
+BENCHMARK(BM_RandomNext);
+
+static void BM_RandomFill(benchmark::State &state)
+{
+  Random random;
+  std::vector<uint32_t> values(state.range(0));
+  for (auto _ : state)
+  {
+    random.Fill(values.data(), values.size());
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RandomFill)->Arg(4)->Arg(1024);
+
+static void BM_SaveSnapshot(benchmark::State &state)
+{
+  Game game(SCREEN_WIDTH, SCREEN_HEIGHT);
+  InitDenseGame(game, state.range(0), state.range(0) / 2);
+  GameSnapshot snapshot;
+  for (auto _ : state)
+  {
+    game.SaveSnapshot(snapshot);
+    benchmark::DoNotOptimize(&snapshot);
+  }
+  state.counters["bricks"] = game.Levels[game.CurrentLevel].Bricks().size();
+}
+BENCHMARK(BM_SaveSnapshot)->Arg(16)->Arg(64);
+
+static void BM_RestoreSnapshot(benchmark::State &state)
+{
+  Game game(SCREEN_WIDTH, SCREEN_HEIGHT);
+  InitDenseGame(game, state.range(0), state.range(0) / 2);
+  for (unsigned int i = 0; i < 8; ++i)
+    game.PowerUps.push_back(PowerUp(static_cast<PowerUpType>(i % POWER_UP_TYPES), glm::vec3(1.0f), 10.0f,
+                                    glm::vec2(i * 60.0f, 0.0f), Texture2D()));
+  GameSnapshot snapshot;
+  game.SaveSnapshot(snapshot);
+  for (auto _ : state)
+    game.RestoreSnapshot(snapshot);
+  state.counters["bricks"] = game.Levels[game.CurrentLevel].Bricks().size();
+}
+BENCHMARK(BM_RestoreSnapshot)->Arg(16)->Arg(64);
+
+static void BM_VecEnvStep(benchmark::State &state)
+{
+  VecEnv env(state.range(0), 0, 1, state.range(1));
+  std::vector<uint8_t> actions(env.Sessions());
+  Random policy;
+  for (auto _ : state)
+  {
+    for (uint8_t &action : actions)
+      action = static_cast<uint8_t>(policy.NextBelow(ACTIONS));
+    env.Step(actions.data());
+  }
+  state.SetItemsProcessed(state.iterations() * env.Sessions());
+}
+BENCHMARK(BM_VecEnvStep)->Args({64, 1})->Args({1024, 1})->Args({1024, 4})->UseRealTime();
@@ -0,0 +1,28 @@
+#include <benchmark/benchmark.h>
+
+#include "bench_common.hpp"
+#include "software_renderer.hpp"
+
+// renders one frame of a game in play (ball launched, particles trailing it) at
+// width x height with the given threads
+static void BM_SoftwareRender(benchmark::State &state)
+{
+  Game game(SCREEN_WIDTH, SCREEN_HEIGHT);
+  game.InitHeadless();
+  game.Keys[GLFW_KEY_SPACE] = true;
+  for (unsigned int tick = 0; tick < 60; ++tick)
+  {
+    game.ProcessInput(1.0f / 60.0f);
+    game.Update(1.0f / 60.0f);
+  }
+  SoftwareRenderer renderer(state.range(0), state.range(1), SCREEN_WIDTH, SCREEN_HEIGHT, state.range(2));
+  Game::LoadSoftwareTextures(renderer);
+  for (auto _ : state)
+  {
+    game.Render(renderer);
+    benchmark::DoNotOptimize(renderer.Pixels());
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["sprites"] = renderer.CachedSprites();
+}
+BENCHMARK(BM_SoftwareRender)->Args({84, 84, 1})->Args({160, 120, 1})->Args({160, 120, 4})->Args({800, 600, 1})->UseRealTime();
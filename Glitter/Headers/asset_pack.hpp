@@ -0,0 +1,88 @@
+#ifndef ASSET_PACK_HPP
+#define ASSET_PACK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mapped_file.hpp"
+
+// An asset pack bundles every asset the game loads into one indexed file that is
+// memory-mapped as a whole. Assets are stored ready to use, so they are served as
+// views into the mapping without any decoding or copying:
+//
+//   AssetPackHeader | AssetPackEntry[EntryCount] (sorted by name) | asset data
+//
+// Shaders are stored as NUL-terminated source, textures as decoded texels and
+// levels in the compiled level format. Asset data is 16 byte aligned, all values
+// are stored in native (little-endian) byte order.
+const char ASSET_PACK_MAGIC[4] = {'B', 'P', 'A', 'K'};
+const uint32_t ASSET_PACK_VERSION = 1;
+
+enum AssetType
+{
+  ASSET_SHADER,
+  ASSET_TEXTURE,
+  ASSET_LEVEL
+};
+
+struct AssetPackHeader
+{
+  char Magic[4];
+  uint32_t Version;
+  uint32_t EntryCount;
+  uint32_t Reserved;
+};
+
+struct AssetPackEntry
+{
+  // asset name, its path relative to the asset root (e.g. "Textures/block.png")
+  char Name[64];
+  uint32_t Type;
+  // texture dimensions and channels per texel, 0 for other assets
+  uint32_t Width, Height, Channels;
+  // location of the data in the pack; Size excludes a shader's terminating NUL
+  uint64_t Offset, Size;
+};
+
+// A read-only, memory-mapped asset pack
+class AssetPack
+{
+public:
+  // maps and validates the pack, returns false if it is missing or not a valid pack
+  bool Open(const char *file);
+  void Close();
+  bool IsOpen() const { return header != nullptr; }
+  // looks up an asset by name, nullptr if the pack doesn't contain it
+  const AssetPackEntry *Find(const char *name) const;
+  // data of an entry, a view into the mapping that stays valid until the pack is closed
+  const unsigned char *Data(const AssetPackEntry &entry) const { return file.Data() + entry.Offset; }
+
+  AssetPack() : header(nullptr), entries(nullptr) {}
+
+private:
+  MappedFile file;
+  const AssetPackHeader *header;
+  const AssetPackEntry *entries;
+};
+
+// Collects assets in memory and writes them out as an asset pack (used by the packer)
+class AssetPackWriter
+{
+public:
+  // adds an asset, returns false if its name doesn't fit the index
+  bool Add(const std::string &name, AssetType type, const unsigned char *data, size_t size,
+           unsigned int width = 0, unsigned int height = 0, unsigned int channels = 0);
+  bool Write(const char *file);
+
+private:
+  struct Asset
+  {
+    AssetPackEntry Entry;
+    std::vector<unsigned char> Data;
+  };
+  std::vector<Asset> assets;
+};
+
+#endif // ASSET_PACK_HPP
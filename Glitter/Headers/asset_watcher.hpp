@@ -0,0 +1,38 @@
+#ifndef ASSET_WATCHER_HPP
+#define ASSET_WATCHER_HPP
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Watches asset directories for changed files on a background thread (inotify, so
+// Linux only) and queues their names, relative to the asset root (e.g.
+// "Shaders/sprite_shader.frag"), until the game picks them up at a frame boundary.
+class AssetWatcher
+{
+public:
+  AssetWatcher();
+  ~AssetWatcher();
+  // starts watching the given directories under root, false if watching isn't possible
+  bool Start(const std::string &root, const std::vector<std::string> &directories);
+  void Stop();
+  // moves the names of files changed since the last poll into changed, false if there are none
+  bool Poll(std::vector<std::string> &changed);
+
+private:
+  int inotifyFd;
+  std::vector<std::pair<int, std::string>> watches;
+  std::thread thread;
+  std::atomic<bool> running;
+  std::mutex queueMutex;
+  std::vector<std::string> queue;
+  // reads inotify events until stopped
+  void watch();
+
+  AssetWatcher(const AssetWatcher &);
+  AssetWatcher &operator=(const AssetWatcher &);
+};
+
+#endif // ASSET_WATCHER_HPP
@@ -0,0 +1,95 @@
+#ifndef BREAKOUT_SIM_H
+#define BREAKOUT_SIM_H
+
+/* C interface of libbreakout_sim, the game's simulation without a window or GL
+ * context, for driving sessions from other languages and tools. Everything is
+ * plain C: sessions are opaque handles, state is read into caller buffers, and
+ * functions that can fail return 1 on success and 0 on failure (running out of
+ * memory included, no C++ exception ever leaves the library). The layout of
+ * bsim_state only changes together with BSIM_ABI_VERSION. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(BREAKOUT_SIM_BUILD)
+#define BSIM_API __declspec(dllexport)
+#elif defined(_WIN32)
+#define BSIM_API __declspec(dllimport)
+#elif defined(__GNUC__)
+#define BSIM_API __attribute__((visibility("default")))
+#else
+#define BSIM_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BSIM_ABI_VERSION 1
+
+/* input bits of a step, the same as a replay's */
+#define BSIM_INPUT_LEFT 1u
+#define BSIM_INPUT_RIGHT 2u
+#define BSIM_INPUT_LAUNCH 4u
+
+/* power-ups, indexing bsim_state.power_up_time */
+#define BSIM_POWER_UPS 6
+
+typedef struct bsim_session bsim_session;
+
+typedef struct bsim_state
+{
+  float paddle_x, paddle_y, paddle_width, paddle_height;
+  float ball_x, ball_y, ball_velocity_x, ball_velocity_y, ball_radius;
+  uint32_t ball_stuck;
+  uint32_t level, brick_count, bricks_destroyed, balls_lost;
+  /* time left of speed, sticky, pass-through, pad-size-increase, confuse and chaos
+     while active, 0 otherwise */
+  float power_up_time[BSIM_POWER_UPS];
+  /* the game's determinism hash (as stored in replays) */
+  uint64_t state_hash;
+} bsim_state;
+
+/* BSIM_ABI_VERSION of the loaded library */
+BSIM_API uint32_t bsim_abi_version(void);
+/* directory the shipped levels are loaded from (by default the source tree the library was built from) */
+BSIM_API void bsim_set_asset_root(const char *path);
+
+/* a session playing the first shipped level, seeded with seed; NULL on failure, e.g. when
+   the shipped levels can't be read from the asset root.
+   bsim_set_asset_root, bsim_create and bsim_load_level use the library's shared resource
+   cache, so none of them may run concurrently with another (or itself); the other calls
+   only touch their own sessions */
+BSIM_API bsim_session *bsim_create(uint32_t seed);
+BSIM_API void bsim_destroy(bsim_session *session);
+/* loads a text (.lvl) or compiled (.blvl) level from memory and switches the session to it,
+   with every brick standing; returns the level's index or -1 */
+BSIM_API int32_t bsim_load_level(bsim_session *session, const void *data, size_t size);
+/* switches to a loaded level (0-3 are the shipped ones), with every brick standing */
+BSIM_API int bsim_set_level(bsim_session *session, uint32_t level);
+
+/* advances the session one tick of dt seconds with the BSIM_INPUT_* bits held */
+BSIM_API void bsim_step(bsim_session *session, uint32_t input, float dt);
+BSIM_API void bsim_read_state(const bsim_session *session, bsim_state *state);
+/* copies the current level's destroyed-brick bits (brick i is bit i % 8 of byte i / 8)
+   if capacity allows, returns the bytes needed */
+BSIM_API size_t bsim_read_bricks(const bsim_session *session, uint8_t *bricks, size_t capacity);
+
+/* snapshots are opaque blobs of bsim_snapshot_size() bytes, restorable into any session
+   of the same level in the same library version */
+BSIM_API size_t bsim_snapshot_size(void);
+BSIM_API int bsim_save(const bsim_session *session, void *snapshot, size_t size);
+BSIM_API int bsim_restore(bsim_session *session, const void *snapshot, size_t size);
+
+/* batched calls over count sessions, one crossing of the ABI for all of them */
+BSIM_API void bsim_step_batch(bsim_session *const *sessions, const uint32_t *inputs, size_t count, float dt);
+BSIM_API void bsim_read_state_batch(bsim_session *const *sessions, bsim_state *states, size_t count);
+/* snapshots are laid out back to back, bsim_snapshot_size() bytes apart; returns the number saved/restored */
+BSIM_API size_t bsim_save_batch(bsim_session *const *sessions, void *snapshots, size_t count);
+BSIM_API size_t bsim_restore_batch(bsim_session *const *sessions, const void *snapshots, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BREAKOUT_SIM_H */
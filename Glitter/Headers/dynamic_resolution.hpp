@@ -0,0 +1,49 @@
+#ifndef DYNAMIC_RESOLUTION_HPP
+#define DYNAMIC_RESOLUTION_HPP
+
+#include "gl_object.hpp"
+
+// GpuTimer measures the GPU time of the commands between Begin and End, once per
+// frame, with GL_TIME_ELAPSED queries. A query is only read a few frames later,
+// when its result is available, so measuring never waits for the GPU.
+class GpuTimer
+{
+public:
+  // queries are counted under subsystem in GLObjectStats
+  explicit GpuTimer(const char *subsystem);
+  void Begin();
+  void End();
+  // the GPU time of the latest frame whose result arrived since the last call
+  bool Result(float &milliseconds);
+
+private:
+  static const unsigned int QUERIES = 4;
+  GLObject queries[QUERIES];
+  // frames begun and frames read back, the ones in between are in flight
+  unsigned int begun, read;
+};
+
+// DynamicResolution picks the render scale of the scene (relative to the framebuffer)
+// between MinScale and MaxScale, so that the measured frame time holds TargetMs. It
+// decides on the average of a few frames at a time, moves in steps of 1/16 and waits
+// a few frames after each change, so a new scale is judged by frames that were
+// actually rendered at it.
+class DynamicResolution
+{
+public:
+  float TargetMs;
+  float MinScale, MaxScale;
+
+  DynamicResolution(float targetMs, float minScale = 0.5f, float maxScale = 1.0f);
+  float Scale() const { return scale; }
+  // feeds one measured frame time, returns whether the scale changed
+  bool Update(float frameMs);
+
+private:
+  float scale;
+  // frame times summed for the next decision, frames fed since the last change
+  float total;
+  unsigned int samples;
+};
+
+#endif // DYNAMIC_RESOLUTION_HPP
@@ -0,0 +1,78 @@
+#ifndef FRAME_CAPTURE_HPP
+#define FRAME_CAPTURE_HPP
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "gl_object.hpp"
+
+// FrameCapture records the frames PostProcessor leaves in the default framebuffer
+// without stalling the pipeline: each frame is read into one of a ring of pixel
+// buffer objects, and only mapped a few frames later, once its fence has signaled.
+// A writer thread then encodes the frames, either as a PNG sequence or as a raw
+// Y4M (YUV 4:2:0) stream. If the writer falls behind, frames are dropped (and
+// counted) rather than holding up the game.
+class FrameCapture
+{
+public:
+  FrameCapture();
+  ~FrameCapture();
+  // starts capturing the bottom-left width x height pixels of every frame. A path
+  // ending in ".y4m" writes a Y4M stream at fps frames per second, anything else is
+  // the prefix of a PNG sequence (path000000.png, path000001.png, ...)
+  bool Start(const std::string &path, unsigned int width, unsigned int height, unsigned int fps = 60);
+  // queues the read of the frame just rendered (call before swapping buffers) and
+  // hands reads that have finished to the writer
+  void Capture();
+  // finishes the outstanding reads, waits for the writer, deletes the buffers and
+  // prints what was captured; needs the GL context to still be current
+  void Stop();
+  bool Active() const { return active; }
+
+private:
+  // ring of reads in flight, oldest first from slot first
+  static const unsigned int SLOTS = 3;
+  struct Slot
+  {
+    GLObject Buffer;
+    GLsync Fence;
+    unsigned int Frame;
+  };
+  Slot slots[SLOTS];
+  unsigned int first, inFlight;
+  bool active;
+  std::string path;
+  unsigned int width, height;
+  bool y4m;
+  FILE *stream;
+  // counters, frames is the number of the next captured frame
+  unsigned int frames, dropped, stalls;
+  // time spent in Capture, i.e. taken from the render thread
+  double captureMs;
+  // maps a finished read (waiting for it if wait is set) and queues its pixels for the writer
+  bool collect(Slot &slot, bool wait);
+
+  // writer thread, encoding queued frames; used buffers go back to freeBuffers so they're reused
+  std::thread writer;
+  std::mutex queueMutex;
+  std::condition_variable queueChanged;
+  std::deque<std::pair<unsigned int, std::vector<unsigned char>>> queue;
+  std::vector<std::vector<unsigned char>> freeBuffers;
+  bool stopping;
+  unsigned int written;
+  void writeFrames();
+  bool writePng(unsigned int frame, const std::vector<unsigned char> &pixels, std::vector<unsigned char> &rgb);
+  bool writeY4m(const std::vector<unsigned char> &pixels, std::vector<unsigned char> &yuv);
+
+  FrameCapture(const FrameCapture &);
+  FrameCapture &operator=(const FrameCapture &);
+};
+
+#endif // FRAME_CAPTURE_HPP
@@ -8,10 +8,17 @@
 #include "sprite_renderer.hpp"
 #include "game_level.hpp"
 #include "game_object.hpp"
+#include "game_snapshot.hpp"
 #include "ball_object.hpp"
 #include "particle_generator.hpp"
 #include "post_processor.hpp"
 #include "power_up.hpp"
+#include "random.hpp"
+#include "resource_manager.hpp"
+
+// The size of the screen: the window's, and every headless session's (VecEnv, libbreakout_sim)
+const unsigned int SCREEN_WIDTH = 800;
+const unsigned int SCREEN_HEIGHT = 600;
 
 enum GameState
 {
@@ -42,23 +49,88 @@ public:
 
   std::vector<PowerUp> PowerUps;
 
+  // Effect state (applied to the PostProcessor when rendering)
+  bool Confuse, Chaos, Shake;
+  // time left of the current shake
+  float ShakeTime;
+  // balls that fell past the paddle (each resets the level), for observers like VecEnv
+  unsigned int BallsLost;
+
+  // Anti-aliasing, set before Init (the window's framebuffer has to match, see AntiAliasing::WindowSamples)
+  AntiAliasing AntiAliasingMode;
+
+  // Random number streams: power-up spawns and particles draw from separate
+  // streams so the amount of particles never changes what gets spawned
+  Random GameplayRandom;
+  Random CosmeticRandom;
+  // particles are only cosmetic, sessions nobody watches (e.g. VecEnv's) can skip them
+  bool UpdateParticles;
+
   // Constructor/Destructor
   Game(unsigned int width, unsigned int height);
   ~Game();
 
   // Initializes game state (load all shaders/textures/levels)
   void Init();
+  // Initializes game state without creating any GL resources (benchmarks, headless simulation)
+  void InitHeadless();
+  // deletes the renderers and their GL objects, while the GL context is still current (the game
+  // can't be rendered after this)
+  void ReleaseRenderers();
 
   // Game loop
   void ProcessInput(float dt);
   void Update(float dt);
-  void Render();
+  // time drives the post-processing effects (chaos/shake animation)
+  void Render(float time);
+  // draws the same scene on the CPU, e.g. for pixel observations without a GL context (the
+  // post-processing effects aren't applied); the renderer needs LoadSoftwareTextures first
+  void Render(SoftwareRenderer &renderer) const;
+  // loads the scene's textures into a software renderer
+  static bool LoadSoftwareTextures(SoftwareRenderer &renderer);
+  // adds the scene to a tile of a spectator wall; tiles large enough get particles and the
+  // effects (time drives the shake). The wall needs SetSpectatorTextures first
+  void Render(SpectatorRenderer &renderer, unsigned int tile, float time) const;
+  // points a spectator wall's texture slots at the loaded scene textures
+  static void SetSpectatorTextures(SpectatorRenderer &renderer);
+  // size of the framebuffer the game is rendered into (larger than Width x Height on high-DPI screens)
+  void SetFramebufferSize(unsigned int width, unsigned int height);
+  // resolution the scene is rendered at, relative to the framebuffer (see DynamicResolution)
+  void SetRenderScale(float scale);
 
   void DoCollisions();
 
-  void SpawnPowerUps(GameObject &block);
+  // read-only views of the paddle and the ball, for observers like VecEnv
+  const GameObject &GetPlayer() const { return *Player; }
+  const BallObject &GetBall() const { return *Ball; }
+
+  // reloads changed asset files (names relative to the asset root) in place, see AssetWatcher
+  void ReloadAssets(const std::vector<std::string> &files);
+
+  void SpawnPowerUps(const GameObject &block);
   void UpdatePowerUps(float dt);
 
+  // Determinism helpers
+  // seeds both random number streams (power-up spawns and particles)
+  void SetSeed(unsigned int seed);
+  // FNV-1a hash over the simulation state (level, paddle, ball, power-ups, effects, gameplay RNG)
+  unsigned long long StateHash() const;
+
+  // Snapshots (cloning a session, e.g. for look-ahead search)
+  // whether the level's bricks and the power-ups fit into a GameSnapshot
+  bool FitsSnapshot() const;
+  // copies the simulation state into snapshot, fails if the level or the power-ups don't fit
+  bool SaveSnapshot(GameSnapshot &snapshot) const;
+  // puts the simulation back into a saved state of the same level layout, fails on
+  // snapshots of other levels or with an unknown state or power-up type; allocates
+  // nothing once PowerUps has grown to the snapshot's power-ups
+  bool RestoreSnapshot(const GameSnapshot &snapshot);
+
+  // collision helpers
+  bool CheckCollision(const GameObject &one, const GameObject &two);
+  Collision CheckCollision(const BallObject &one, const GameObject &two);
+  Direction VectorDirection(glm::vec2 target);
+
 private:
   SpriteRenderer *Renderer;
   GameObject *Player;
@@ -66,19 +138,27 @@ private:
   ParticleGenerator *Particles;
   PostProcessor *Effects;
 
+  // textures used while playing, resolved once so the game loop does no name lookups
+  TextureHandle BackgroundTexture;
+  TextureHandle SpeedTexture, StickyTexture, PassThroughTexture, IncreaseTexture, ConfuseTexture, ChaosTexture;
+
+  // Init Helpers
+  void LoadLevels();
+  void InitPlayer();
+  void ResolveHandles();
+  // sets the constant uniforms of the sprite and particle shaders
+  void ConfigureShaders();
+
   // Reset Helpers
   void ResetLevel();
   void ResetPlayer();
 
-  // collision helpers
-  bool CheckCollision(GameObject &one, GameObject &two);
-  Collision CheckCollision(BallObject &one, GameObject &two);
-  Direction VectorDirection(glm::vec2 target);
-
   // Powerup Helpers
   bool ShouldSpawn(unsigned int chance);
+  // a power-up of the given type (with its color, duration and texture) at position
+  PowerUp CreatePowerUp(PowerUpType type, glm::vec2 position) const;
   void ActivatePowerUp(PowerUp &powerUp);
-  bool IsOtherPowerUpActive(std::vector<PowerUp> &powerUps, std::string type);
+  bool IsOtherPowerUpActive(std::vector<PowerUp> &powerUps, PowerUpType type);
 };
 
 #endif // GAME_H
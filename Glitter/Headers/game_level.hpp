@@ -1,27 +1,66 @@
 #ifndef GAME_LEVEL_HPP
 #define GAME_LEVEL_HPP
 
+#include <cstdint>
+#include <memory>
+
 #include "game_object.hpp"
+#include "level_format.hpp"
+#include "software_renderer.hpp"
+#include "spectator_renderer.hpp"
 #include "sprite_renderer.hpp"
 
-class GameLevel
+// LevelTemplate is a level as loaded: position, size, color and texture of every brick.
+// A template is read-only once loaded, so one copy is shared by every session playing
+// the level (see ResourceManager::LoadLevel) and each session only keeps which bricks
+// it destroyed, in its GameLevel.
+class LevelTemplate
 {
 public:
-  // level state
   std::vector<GameObject> Bricks;
+  // one bit per brick, set for the bricks that have to be destroyed to complete the level
+  std::vector<uint8_t> Breakable;
   // constructor
-  GameLevel() {}
-  // loads level from file
+  LevelTemplate() {}
+  // loads level from file, either a text level (.lvl) or a compiled level (.blvl) which
+  // is memory-mapped and used without any parsing
   void Load(const char *file, unsigned int levelWidth, unsigned int levelHeight);
-  // render level
-  void Draw(SpriteRenderer &renderer);
-  // check if the level is completed (all non-solid tiles are destroyed)
-  bool IsCompleted();
+  // loads level from a text or compiled level held in memory (e.g. an asset pack)
+  void Load(const unsigned char *data, size_t size, unsigned int levelWidth, unsigned int levelHeight);
 
 private:
-  // initialize level from tile data
-  void init(std::vector<std::vector<unsigned int>> tileData,
-            unsigned int levelWidth, unsigned int levelHeight);
+  // initialize level from row-major tile codes and the brick properties per code
+  void init(const unsigned char *tiles, unsigned int width, unsigned int height,
+            const LevelTileInfo *tileTable, unsigned int levelWidth, unsigned int levelHeight);
+};
+
+class GameLevel
+{
+public:
+  // the bricks, shared with other sessions
+  std::shared_ptr<const LevelTemplate> Template;
+  // level state, one bit per brick of the template, set once it's destroyed
+  std::vector<uint8_t> Destroyed;
+  // constructor(s), an empty level or a session of a loaded template
+  GameLevel();
+  explicit GameLevel(std::shared_ptr<const LevelTemplate> levelTemplate);
+  // loads a template of its own (not shared with anyone), see LevelTemplate::Load
+  void Load(const char *file, unsigned int levelWidth, unsigned int levelHeight);
+  void Load(const unsigned char *data, size_t size, unsigned int levelWidth, unsigned int levelHeight);
+  // brick access
+  const std::vector<GameObject> &Bricks() const { return Template->Bricks; }
+  bool IsDestroyed(size_t brick) const { return (Destroyed[brick / 8] >> (brick % 8)) & 1; }
+  void Destroy(size_t brick) { Destroyed[brick / 8] |= static_cast<uint8_t>(1 << (brick % 8)); }
+  // brings back every destroyed brick
+  void Reset();
+  // render level
+  void Draw(SpriteRenderer &renderer) const;
+  // render level in software, with the renderer's textures of solid and breakable bricks
+  void Draw(SoftwareRenderer &renderer, unsigned int blockTexture, unsigned int solidTexture) const;
+  // render level into a tile of a spectator wall, with its textures of solid and breakable bricks
+  void Draw(SpectatorRenderer &renderer, unsigned int tile, unsigned int blockTexture, unsigned int solidTexture) const;
+  // check if the level is completed (all non-solid tiles are destroyed)
+  bool IsCompleted() const;
 };
 
-#endif // GAME_LEVEL_HPP
\ No newline at end of file
+#endif // GAME_LEVEL_HPP
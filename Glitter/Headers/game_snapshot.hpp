@@ -0,0 +1,45 @@
+#ifndef GAME_SNAPSHOT_HPP
+#define GAME_SNAPSHOT_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+#include <glm/glm.hpp>
+
+#include "random.hpp"
+
+// capacity of a snapshot; Game::SaveSnapshot fails on sessions that don't fit
+const unsigned int SNAPSHOT_MAX_BRICKS = 2048;
+const unsigned int SNAPSHOT_MAX_POWER_UPS = 32;
+
+struct PowerUpSnapshot
+{
+  glm::vec2 Position;
+  float Duration;
+  uint8_t Type, Activated, Destroyed;
+};
+
+// GameSnapshot is everything Game::Update reads and writes, as plain data: it can be
+// copied with memcpy, written to a file or sent to another process as is. Bricks of
+// the current level are one bit each (destroyed or not), their layout comes from the
+// level itself. Particles and the cosmetic random stream are left out, they never
+// change the outcome of a session (see Game::StateHash).
+struct GameSnapshot
+{
+  uint32_t State, CurrentLevel;
+  glm::vec2 PlayerPosition, PlayerSize;
+  glm::vec3 PlayerColor;
+  glm::vec2 BallPosition, BallVelocity;
+  glm::vec3 BallColor;
+  uint8_t BallStuck, BallSticky, BallPassThrough;
+  uint8_t Confuse, Chaos, Shake;
+  float ShakeTime;
+  Random GameplayRandom;
+  uint32_t BrickCount, PowerUpCount;
+  uint8_t DestroyedBricks[SNAPSHOT_MAX_BRICKS / 8];
+  PowerUpSnapshot PowerUps[SNAPSHOT_MAX_POWER_UPS];
+};
+
+static_assert(std::is_trivially_copyable<GameSnapshot>::value, "GameSnapshot has to be plain data");
+
+#endif // GAME_SNAPSHOT_HPP
@@ -0,0 +1,79 @@
+#ifndef GL_OBJECT_HPP
+#define GL_OBJECT_HPP
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+enum GLObjectType
+{
+  GL_OBJECT_TEXTURE,
+  GL_OBJECT_BUFFER,
+  GL_OBJECT_VERTEX_ARRAY,
+  GL_OBJECT_FRAMEBUFFER,
+  GL_OBJECT_RENDERBUFFER,
+  GL_OBJECT_PROGRAM,
+  GL_OBJECT_QUERY,
+  GL_OBJECT_TYPES
+};
+
+// GLObject owns one GL object name and deletes it when destroyed. It can only be
+// moved, so every GL object has exactly one owner; everything else refers to the
+// object by its plain ID (Texture2D and Shader are such non-owning handles, cheap
+// to copy). Owners are counted per subsystem in GLObjectStats, together with an
+// estimate of the video memory they hold.
+class GLObject
+{
+public:
+  // an empty object (no GL name, needs no GL context)
+  GLObject();
+  // generates a new GL name (programs are created with glCreateProgram)
+  GLObject(GLObjectType type, const char *subsystem);
+  // takes ownership of an existing GL name
+  GLObject(GLObjectType type, unsigned int id, const char *subsystem);
+  ~GLObject();
+  GLObject(GLObject &&other);
+  GLObject &operator=(GLObject &&other);
+  GLObject(const GLObject &) = delete;
+  GLObject &operator=(const GLObject &) = delete;
+
+  unsigned int ID() const { return id; }
+  explicit operator bool() const { return id != 0; }
+  // records the (estimated) video memory the object's storage takes
+  void SetBytes(size_t bytes);
+  // deletes the GL object, leaving this one empty
+  void Reset();
+
+private:
+  GLObjectType type;
+  unsigned int id;
+  const char *subsystem;
+  size_t bytes;
+};
+
+// A static registry of the live GL objects owned by GLObjects, with their
+// counts and estimated video memory per subsystem (e.g. "textures", "sprites").
+class GLObjectStats
+{
+public:
+  struct Usage
+  {
+    unsigned int Count[GL_OBJECT_TYPES];
+    size_t Bytes;
+    Usage() : Count(), Bytes(0) {}
+    unsigned int Objects() const;
+  };
+  // live objects per subsystem
+  static const std::map<std::string, Usage> &Subsystems() { return subsystems; }
+  // live objects of all subsystems together
+  static Usage Total();
+  // prints a table of the live objects per subsystem
+  static void Print();
+
+private:
+  friend class GLObject;
+  static std::map<std::string, Usage> subsystems;
+  GLObjectStats() {}
+};
+
+#endif // GL_OBJECT_HPP
@@ -0,0 +1,28 @@
+#ifndef HASH_HPP
+#define HASH_HPP
+
+#include <cstddef>
+
+// 64 bit FNV-1a, used for state hashes, frame checksums and cache keys
+const unsigned long long HASH_OFFSET_BASIS = 14695981039346656037ULL;
+const unsigned long long HASH_PRIME = 1099511628211ULL;
+
+// folds size bytes at data into an FNV-1a hash
+inline void HashBytes(unsigned long long &hash, const void *data, size_t size)
+{
+  const unsigned char *bytes = static_cast<const unsigned char *>(data);
+  for (size_t i = 0; i < size; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= HASH_PRIME;
+  }
+}
+
+// FNV-1a hash of a NUL-terminated name, usable at compile time, e.g.
+//   const unsigned long long BACKGROUND = HashName("background");
+constexpr unsigned long long HashName(const char *name, unsigned long long hash = HASH_OFFSET_BASIS)
+{
+  return *name ? HashName(name + 1, (hash ^ static_cast<unsigned char>(*name)) * HASH_PRIME) : hash;
+}
+
+#endif // HASH_HPP
@@ -0,0 +1,27 @@
+#ifndef HEADLESS_CONTEXT_HPP
+#define HEADLESS_CONTEXT_HPP
+
+// HeadlessContext creates an OpenGL 3.3 core context without a window or display
+// server, through EGL's surfaceless platform (Mesa; llvmpipe on hosts without a GPU).
+// Rendering goes into a pbuffer, so the default framebuffer behaves like the one of
+// a GLFW window. Only available when the build found EGL (GLITTER_HAS_EGL).
+class HeadlessContext
+{
+public:
+  // constructor/destructor
+  HeadlessContext();
+  ~HeadlessContext();
+  // creates the context with a width x height default framebuffer (multisampled if samples > 1, when
+  // available) and makes it current
+  bool Create(unsigned int width, unsigned int height, unsigned int samples = 0);
+  // releases the context and its surface
+  void Destroy();
+  // GL function loader to hand to gladLoadGLLoader
+  static void *GetProcAddress(const char *name);
+
+private:
+  // EGLDisplay, EGLContext and EGLSurface, kept opaque so EGL headers stay out of the game
+  void *display, *context, *surface;
+};
+
+#endif // HEADLESS_CONTEXT_HPP
@@ -0,0 +1,56 @@
+#ifndef LEVEL_FORMAT_HPP
+#define LEVEL_FORMAT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Text levels (.lvl) are the source format: rows of whitespace separated tile codes,
+// 0 is empty, 1 a solid brick and 2-5 coloured bricks. The level compiler turns them
+// into compiled levels (.blvl) that are memory-mapped and used in place:
+//
+//   LevelFileHeader | LevelTileInfo[256] | Width * Height tile codes (uint8, row-major)
+//
+// All values are stored in native (little-endian) byte order.
+const char LEVEL_FILE_MAGIC[4] = {'B', 'L', 'V', 'L'};
+const uint32_t LEVEL_FILE_VERSION = 1;
+
+struct LevelFileHeader
+{
+  char Magic[4];
+  uint32_t Version;
+  // level size in tiles
+  uint32_t Width, Height;
+  // number of non-empty tiles, i.e. the number of bricks the level creates
+  uint32_t BrickCount;
+  // byte offsets of the tile table and the tile codes from the start of the file
+  uint32_t TableOffset, TilesOffset;
+};
+
+// Precomputed brick properties per tile code
+struct LevelTileInfo
+{
+  float Color[3];
+  uint32_t Solid;
+};
+
+// Tile grid of a level, one code per tile, row-major
+struct LevelTiles
+{
+  unsigned int Width, Height;
+  std::vector<unsigned char> Codes;
+};
+
+// brick properties of the built-in tile codes, indexed by tile code
+const LevelTileInfo *DefaultTileTable();
+// parses a text level held in memory, returns false if it has no tiles or invalid codes
+bool ParseLevelText(const char *text, size_t size, LevelTiles &tiles);
+// builds a compiled level from tiles using the default tile table
+void CompileLevel(const LevelTiles &tiles, std::vector<unsigned char> &compiled);
+// writes tiles as a compiled level file
+bool WriteCompiledLevel(const char *file, const LevelTiles &tiles);
+// validates a compiled level held in memory, returns its header or nullptr if the data
+// is not a (complete) compiled level of this version
+const LevelFileHeader *ReadCompiledLevel(const unsigned char *data, size_t size);
+
+#endif // LEVEL_FORMAT_HPP
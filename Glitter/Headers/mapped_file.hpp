@@ -0,0 +1,33 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+
+// MappedFile maps a whole file read-only into memory (mmap, MapViewOfFile on
+// Windows), so binary assets can be used in place instead of being read and
+// parsed. The mapping lives as long as the MappedFile.
+class MappedFile
+{
+public:
+  // constructor/destructor
+  MappedFile();
+  ~MappedFile();
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  // maps the file, returns false if it can't be opened (an empty file maps to no data)
+  bool Open(const char *file);
+  // unmaps the file
+  void Close();
+  // mapped contents
+  const unsigned char *Data() const { return data; }
+  size_t Size() const { return size; }
+
+private:
+  const unsigned char *data;
+  size_t size;
+#ifdef _WIN32
+  void *fileHandle, *mappingHandle;
+#endif
+};
+
+#endif // MAPPED_FILE_HPP
@@ -4,7 +4,11 @@
 #include <glm/glm.hpp>
 
 #include "game_object.hpp"
+#include "gl_object.hpp"
+#include "random.hpp"
 #include "shader.hpp"
+#include "software_renderer.hpp"
+#include "spectator_renderer.hpp"
 
 struct Particle
 {
@@ -19,23 +23,32 @@ struct Particle
 class ParticleGenerator
 {
 public:
-  ParticleGenerator(Shader shader, Texture2D texture, unsigned int nr_particles);
+  // random is the (cosmetic) stream new particles draw from, it has to outlive the generator
+  ParticleGenerator(Shader shader, Texture2D texture, unsigned int nr_particles, Random &random);
 
   void Update(float dt, GameObject &object, unsigned int nr_new_particles, glm::vec2 offset);
   void Draw();
+  // draws the living particles in software, with the renderer's texture of a particle
+  void Draw(SoftwareRenderer &renderer, unsigned int texture) const;
+  // draws the living particles into a tile of a spectator wall
+  void Draw(SpectatorRenderer &renderer, unsigned int tile, unsigned int texture) const;
 
 private:
   Shader ParticleShader;
   Texture2D ParticleTex;
+  Random &random;
 
-  unsigned int particleVAO;
+  GLObject particleVAO, particleVBO;
 
   // unsigned int nr_particles = 500;
   unsigned int lastUsedParticle = 0;
   std::vector<Particle> particles;
+  // scratch buffer for the random values of one update's respawns
+  std::vector<uint32_t> randomValues;
 
   unsigned int FirstUnusedParticle();
-  void RespawnParticle(Particle &particle, GameObject &object, glm::vec2 offset);
+  void RespawnParticle(Particle &particle, GameObject &object, glm::vec2 offset,
+                       uint32_t randomOffset, uint32_t randomColor);
   void initRenderData();
 };
 
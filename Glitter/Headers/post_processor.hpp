@@ -12,41 +12,144 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include <string>
+#include <vector>
+
+#include "gl_object.hpp"
+#include "render_target_pool.hpp"
 #include "texture.hpp"
 #include "sprite_renderer.hpp"
 #include "shader.hpp"
 
+// effect bits, a combination of them selects a post-processing shader variant
+enum PostEffect
+{
+  POST_EFFECT_CHAOS = 1,
+  POST_EFFECT_CONFUSE = 2,
+  POST_EFFECT_SHAKE = 4,
+  POST_EFFECT_FXAA = 8, // not a game effect, the FXAA anti-aliasing mode
+  POST_EFFECT_COMBINATIONS = 16
+};
+
+enum AntiAliasingMode
+{
+  AA_NONE,
+  AA_MSAA, // Factor samples per pixel, at the framebuffer's resolution
+  AA_SSAA, // rendered at Factor times the framebuffer's resolution and filtered down
+  AA_FXAA  // FXAA filter in the effects pass
+};
+
+// how the game's edges are anti-aliased, chosen before the window is created
+struct AntiAliasing
+{
+  AntiAliasingMode Mode;
+  unsigned int Factor;
+
+  AntiAliasing(AntiAliasingMode mode = AA_MSAA, unsigned int factor = 4) : Mode(mode), Factor(factor) {}
+  // parses "none", "fxaa", "msaa<samples>" (e.g. "msaa4") or "ssaa2"
+  static bool Parse(const char *text, AntiAliasing &antiAliasing);
+  std::string Name() const;
+  // samples the window's (default) framebuffer needs, it's only multisampled for MSAA
+  unsigned int WindowSamples() const { return Mode == AA_MSAA ? Factor : 0; }
+};
+
 // PostProcessor hosts all PostProcessing effects for the Breakout
 // Game. It renders the game on a textured quad after which one can
 // enable specific effects by enabling either the Confuse, Chaos or
 // Shake boolean.
 // It is required to call BeginRender() before rendering the game
 // and EndRender() after rendering the game for the class to work.
+// The stages (scene, MSAA resolve, effects, upscale) form a small pass graph
+// that is compiled whenever the enabled effects change: passes that
+// don't contribute to the frame are culled, and with no effect enabled
+// the game is rendered straight into the default framebuffer.
+// Intermediate render targets come from a pool sized to the framebuffer.
+// The scene target follows the anti-aliasing mode: multisampled (MSAA),
+// larger than the framebuffer (SSAA, filtered down by the resolve) or
+// plain (none, FXAA; the resolve is then culled as a mere copy).
+// The effects pass binds a shader variant compiled for exactly the
+// enabled effects, so it never branches on them.
+// The scene and the effects can be rendered at a lower resolution
+// (SetRenderScale, see DynamicResolution); an upscale pass then draws
+// the result over the framebuffer.
 class PostProcessor
 {
 public:
   // state
-  Shader PostProcessingShader;
-  Texture2D Texture;
-  unsigned int Width, Height;
+  Shader Shaders[POST_EFFECT_COMBINATIONS]; // shader variants by Variant()
+  unsigned int Width, Height; // framebuffer size
   // options
   bool Confuse, Chaos, Shake;
-  // constructor
-  PostProcessor(Shader shader, unsigned int width, unsigned int height);
-  // prepares the postprocessor's framebuffer operations before rendering the game
+  // constructor, shaders holds the variants by Variant() (see VariantDefines). The default framebuffer
+  // has to be multisampled (or not) according to antiAliasing.WindowSamples()
+  PostProcessor(const Shader shaders[POST_EFFECT_COMBINATIONS], unsigned int width, unsigned int height,
+                const AntiAliasing &antiAliasing);
+  // sets the shaders' constant uniforms (sampler, offsets and kernels), again after they were recompiled
+  void ConfigureShaders();
+  // the variant rendering a combination of effects; chaos overrides confuse, so those two share one
+  static unsigned int Variant(unsigned int effects);
+  // resource name and #defines (CHAOS, CONFUSE, SHAKE, FXAA) of a variant
+  static std::string VariantName(unsigned int variant);
+  static std::string VariantDefines(unsigned int variant);
+  // resizes the render targets along with the framebuffer
+  void Resize(unsigned int width, unsigned int height);
+  // resolution of the scene relative to the framebuffer (1 by default), applied from the next BeginRender
+  void SetRenderScale(float scale) { renderScale = scale; }
+  float RenderScale() const { return renderScale; }
+  // compiles the pass graph for the enabled effects and binds the framebuffer the game is rendered into
   void BeginRender();
-  // should be called after rendering the game, so it stores all the rendered data into a texture object
-  void EndRender();
-  // renders the PostProcessor texture quad (as a screen-encompassing large sprite)
-  void Render(float time);
+  // should be called after rendering the game, runs the remaining passes into the default framebuffer
+  void EndRender(float time);
+  // names of the passes that run this frame, in order (e.g. for logging)
+  std::vector<const char *> ActivePasses() const;
 
 private:
+  // one stage of the graph, reading the render target Input and writing Output
+  enum PassKind
+  {
+    PASS_SCENE,   // the game's draw calls
+    PASS_RESOLVE, // copy (and multisample resolve) of Input into Output
+    PASS_EFFECTS, // full-screen post_proc_shader quad sampling Input
+    PASS_UPSCALE  // the same quad without effects, stretching Input over Output
+  };
+  struct Pass
+  {
+    const char *Name;
+    PassKind Kind;
+    const char *Input, *Output;
+  };
+  // the graph, in execution order
+  static const Pass graph[];
+  static const unsigned int graphSize;
+  // a pass that survived culling, with the render targets assigned to it (nullptr is the default framebuffer)
+  struct CompiledPass
+  {
+    const Pass *Source;
+    RenderTarget *Input, *Output;
+  };
+  std::vector<CompiledPass> compiled;
+  // enabled passes (one bit per pass) and render scale the graph was compiled for
+  unsigned int compiledFor;
+  float renderScale, compiledScale;
+  RenderTargetPool targets;
+  AntiAliasing antiAliasing;
+  unsigned int backbufferSamples;
   // render state
-  unsigned int MSFBO, FBO; // MSFBO = Multisampled FBO. FBO is regular, used for blitting MS color-buffer to texture
-  unsigned int RBO;        // RBO is used for multisampled color buffer
-  unsigned int VAO;
+  GLObject VAO, VBO;
+  // effect bits of the current options
+  unsigned int effects() const;
+  // whether a pass contributes with the current options
+  bool enabled(const Pass &pass) const;
+  // what a named render target has to be
+  RenderTargetDesc describe(const std::string &target) const;
+  // whether a resolve pass is a plain copy (its input could as well be rendered into its output)
+  bool copyOnly(const Pass &pass, const std::string &output) const;
+  // culls and aliases passes, then assigns pooled render targets to the rest
+  void compile();
+  void bindOutput(const CompiledPass &pass);
+  void configureShader(Shader &shader);
   // initialize quad for rendering postprocessing texture
   void initRenderData();
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -6,14 +6,33 @@
 const glm::vec2 SIZE(60.0f, 20.0f);
 const glm::vec2 VELOCITY(0.0f, 150.0f);
 
+enum PowerUpType
+{
+  POWER_UP_SPEED,
+  POWER_UP_STICKY,
+  POWER_UP_PASS_THROUGH,
+  POWER_UP_PAD_SIZE_INCREASE,
+  POWER_UP_CONFUSE,
+  POWER_UP_CHAOS,
+  POWER_UP_TYPES
+};
+
+// the type's name ("speed", "sticky", "pass-through", ...)
+inline const char *PowerUpName(PowerUpType type)
+{
+  static const char *const names[POWER_UP_TYPES] = {"speed", "sticky", "pass-through", "pad-size-increase",
+                                                    "confuse", "chaos"};
+  return names[type];
+}
+
 class PowerUp : public GameObject
 {
 public:
-  std::string Type;
+  PowerUpType Type;
   float Duration;
   bool Activated;
 
-  PowerUp(std::string type, glm::vec3 color, float duration,
+  PowerUp(PowerUpType type, glm::vec3 color, float duration,
           glm::vec2 position, Texture2D texture)
       : GameObject(position, SIZE, texture, color, VELOCITY),
         Type(type), Duration(duration), Activated()
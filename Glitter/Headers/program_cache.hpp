@@ -0,0 +1,55 @@
+#ifndef PROGRAM_CACHE_HPP
+#define PROGRAM_CACHE_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "shader.hpp"
+
+// An on-disk cache of linked shader programs (glGetProgramBinary), so programs are
+// only compiled from source once per driver. Every program gets one cache file
+// named after its key, the hash of its sources and of the GL vendor, renderer and
+// version strings:
+//
+//   ProgramCacheHeader | program binary (Length bytes)
+//
+// A binary the driver rejects (e.g. after a driver update that kept the version
+// string) is thrown away and the program is compiled from source again.
+const char PROGRAM_CACHE_MAGIC[4] = {'B', 'P', 'R', 'G'};
+const uint32_t PROGRAM_CACHE_VERSION = 1;
+
+struct ProgramCacheHeader
+{
+  char Magic[4];
+  uint32_t Version;
+  // binary format reported by glGetProgramBinary
+  uint32_t Format;
+  uint32_t Length;
+  uint64_t Key;
+};
+
+// A static singleton that loads and stores program binaries. Needs a current GL
+// context with ARB_get_program_binary (core in 4.1); without it nothing is cached.
+class ProgramCache
+{
+public:
+  // directory cache files are kept in, caching is off while it's empty
+  static std::string Directory;
+  // turns caching on, creating the cache directory if needed
+  static bool Enable(const std::string &directory);
+  // creates shader's program from the cached binary for these sources, false on a miss
+  static bool Load(const char *vertexSource, const char *fragmentSource, const char *geometrySource, Shader &shader);
+  // stores the binary of shader's linked program for these sources
+  static bool Store(const char *vertexSource, const char *fragmentSource, const char *geometrySource, const Shader &shader);
+
+private:
+  ProgramCache() {}
+  // whether the context can retrieve and load program binaries
+  static bool supported();
+  // cache key of a program: its sources and the driver it was compiled by
+  static uint64_t key(const char *vertexSource, const char *fragmentSource, const char *geometrySource);
+  // path of the cache file for a key
+  static std::string entryPath(uint64_t key);
+};
+
+#endif // PROGRAM_CACHE_HPP
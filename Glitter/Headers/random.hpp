@@ -0,0 +1,64 @@
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Stream ids, so one session seed gives independent gameplay and cosmetic streams
+enum RandomStream
+{
+  STREAM_GAMEPLAY,
+  STREAM_COSMETIC
+};
+
+// Random is a small seedable pseudo random number generator (xoshiro128**).
+// Unlike the global rand() every instance has its own state, so each Game owns
+// its streams: sessions can run side by side on different threads and replay
+// deterministically, and cosmetic randomness (particles) never shifts gameplay
+// randomness (power-up spawns).
+class Random
+{
+public:
+  // generator state, plain data so it can be saved and restored
+  uint32_t State[4];
+  // state of the four interleaved lanes used by Fill
+  uint32_t Lanes[4][4];
+  // constructor
+  Random(uint64_t seed = 1, unsigned int stream = STREAM_GAMEPLAY);
+  // (re)seeds the generator, different streams of the same seed are independent
+  void Seed(uint64_t seed, unsigned int stream = STREAM_GAMEPLAY);
+  // next 32 random bits
+  uint32_t Next()
+  {
+    uint32_t result = rotl(State[1] * 5, 7) * 9;
+    uint32_t t = State[1] << 9;
+    State[2] ^= State[0];
+    State[3] ^= State[1];
+    State[1] ^= State[2];
+    State[0] ^= State[3];
+    State[2] ^= t;
+    State[3] = rotl(State[3], 11);
+    return result;
+  }
+  // uniform integer in [0, bound)
+  uint32_t NextBelow(uint32_t bound)
+  {
+    return static_cast<uint32_t>((static_cast<uint64_t>(Next()) * bound) >> 32);
+  }
+  // uniform float in [0, 1)
+  float NextFloat()
+  {
+    return (Next() >> 8) * (1.0f / 16777216.0f);
+  }
+  // bulk path: fills count values from four independent lanes, laid out so the
+  // compiler vectorizes the inner loop (one SSE2/NEON register per state word)
+  void Fill(uint32_t *values, size_t count);
+
+private:
+  static uint32_t rotl(uint32_t x, int k)
+  {
+    return (x << k) | (x >> (32 - k));
+  }
+};
+
+#endif // RANDOM_HPP
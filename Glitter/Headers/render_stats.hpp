@@ -0,0 +1,27 @@
+#ifndef RENDER_STATS_HPP
+#define RENDER_STATS_HPP
+
+// A static collection of counters for the GL work submitted by Shader, Texture2D,
+// SpriteRenderer, ParticleGenerator and PostProcessor. Counters only ever grow;
+// whoever is measuring (e.g. the render benchmark, once per frame) resets them.
+class RenderStats
+{
+public:
+  // counters
+  static unsigned int DrawCalls;
+  static unsigned int ShaderBinds;
+  static unsigned int TextureBinds;
+  static unsigned int VertexArrayBinds;
+  static unsigned int FramebufferBinds;
+  static unsigned int BlendChanges;
+  static unsigned int UniformUploads;
+  // sum of all counted state changes (everything but draw calls)
+  static unsigned int StateChanges();
+  // sets all counters back to zero
+  static void Reset();
+
+private:
+  RenderStats() {}
+};
+
+#endif // RENDER_STATS_HPP
@@ -0,0 +1,72 @@
+#ifndef RENDER_TARGET_POOL_HPP
+#define RENDER_TARGET_POOL_HPP
+
+#include <memory>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "gl_object.hpp"
+#include "texture.hpp"
+
+// what a render target has to be; its size is relative to the pool's (framebuffer) size
+struct RenderTargetDesc
+{
+  unsigned int Samples; // > 1 is a multisampled renderbuffer, otherwise a texture that can be sampled
+  GLenum Format;
+  float Scale;
+
+  RenderTargetDesc(unsigned int samples = 1, GLenum format = GL_RGB, float scale = 1.0f)
+      : Samples(samples), Format(format), Scale(scale) {}
+  bool operator==(const RenderTargetDesc &other) const
+  {
+    return Samples == other.Samples && Format == other.Format && Scale == other.Scale;
+  }
+};
+
+// a framebuffer with a single color attachment
+struct RenderTarget
+{
+  RenderTargetDesc Desc;
+  unsigned int Width, Height;
+  GLObject Framebuffer;
+  GLObject Storage; // renderbuffer (multisampled) or texture
+  Texture2D Texture; // handle of Storage when it's a texture
+  bool InUse;
+
+  RenderTarget() : Width(0), Height(0), InUse(false) {}
+};
+
+// RenderTargetPool hands out render targets by description and takes them back, so
+// targets whose lifetimes don't overlap share (alias) the same GL objects. Targets
+// are only created when first acquired, so effects that never run cost no video
+// memory. Resizing drops every target; they're recreated at the new size on demand.
+class RenderTargetPool
+{
+public:
+  // targets are counted under subsystem in GLObjectStats
+  RenderTargetPool(const char *subsystem, unsigned int width, unsigned int height);
+  // size targets are relative to (the framebuffer size)
+  unsigned int Width() const { return width; }
+  unsigned int Height() const { return height; }
+  void Resize(unsigned int width, unsigned int height);
+  // a free target matching desc, created if there is none
+  RenderTarget *Acquire(const RenderTargetDesc &desc);
+  // returns a target to the pool, its contents may be overwritten by the next owner
+  void Release(RenderTarget *target);
+  // releases every target
+  void ReleaseAll();
+  // deletes every target, e.g. when the sizes they're needed at change
+  void Clear();
+  // number of GL render targets the pool holds
+  size_t Size() const { return targets.size(); }
+
+private:
+  const char *subsystem;
+  unsigned int width, height;
+  // owned through pointers so acquired targets stay put when the pool grows
+  std::vector<std::unique_ptr<RenderTarget>> targets;
+  void create(RenderTarget &target);
+};
+
+#endif // RENDER_TARGET_POOL_HPP
@@ -0,0 +1,58 @@
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+#include <vector>
+
+#include "game.hpp"
+
+// Input bits stored per simulation tick: the keys Game::ProcessInput reacts to,
+// folded into what they do (A and LEFT both move the paddle left, etc.)
+enum ReplayInput
+{
+  INPUT_LEFT = 1 << 0,
+  INPUT_RIGHT = 1 << 1,
+  INPUT_LAUNCH = 1 << 2
+};
+
+// One simulation tick: the frame's delta time and the ReplayInput bits held during it
+struct ReplayTick
+{
+  float DeltaTime;
+  unsigned char Input;
+};
+
+// A recorded play session: everything needed to re-run a Game bit-exactly, i.e. the
+// RNG seed, the level and screen size the session started with, and the input and
+// delta time of every tick. Replays drive both headless simulations and rendered runs,
+// and FinalStateHash (Game::StateHash() at the end of the recording) turns every
+// replay into a determinism check.
+class Replay
+{
+public:
+  // session setup
+  unsigned int Seed;
+  unsigned int Level;
+  unsigned int Width, Height;
+  // recorded ticks
+  std::vector<ReplayTick> Ticks;
+  // Game::StateHash() after the last tick, 0 if unknown
+  unsigned long long FinalStateHash;
+  // constructor
+  Replay();
+  // starts a new recording of the given (initialized) game and seeds it
+  void Begin(Game &game, unsigned int seed);
+  // appends a tick with the current key state of the game
+  void Record(const Game &game, float dt);
+  // seeds and positions an initialized game where the recording started, false if the
+  // game doesn't have the recorded level
+  bool Start(Game &game) const;
+  // writes tick i's input into game.Keys
+  void Apply(Game &game, unsigned int tick) const;
+  // plays all ticks without rendering, false if the replay can't start (see Start)
+  bool Simulate(Game &game) const;
+  // replay file io, returns false on failure
+  bool Save(const char *file) const;
+  bool Load(const char *file);
+};
+
+#endif // REPLAY_HPP
@@ -1,43 +1,157 @@
 #ifndef RESOURCE_MANAGER_H
 #define RESOURCE_MANAGER_H
 
+#include <future>
 #include <map>
+#include <memory>
 #include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
 
 #include <glad/glad.h>
 
+#include "asset_pack.hpp"
+#include "game_level.hpp"
+#include "gl_object.hpp"
+#include "hash.hpp"
+#include "resource_registry.hpp"
 #include "texture.hpp"
 #include "shader.hpp"
 
+typedef ResourceHandle<Texture2D> TextureHandle;
+typedef ResourceHandle<Shader> ShaderHandle;
+
 // A static singleton ResourceManager class that hosts several
 // functions to load Textures and Shaders. Each loaded texture
-// and/or shader is also stored for future reference by string
-// handles. All functions and resources are static and no
-// public constructor is defined.
+// and/or shader is also stored for future reference by name.
+// Names are resolved to handles once (e.g. at load time), after
+// that a texture or shader is an array index away. All functions
+// and resources are static and no public constructor is defined.
+// Asset names are paths relative to AssetRoot (e.g. "Textures/block.png"). When
+// an asset pack is mounted, assets it contains are served straight from the
+// mapped pack and only assets missing from it are read from AssetRoot.
+// Textures and levels can be queued first, so they are decoded and compiled on
+// worker threads while the caller does other work (e.g. compiling shaders); the
+// GL uploads always happen on the thread that finishes them.
+// Loose images are decoded once and then read from the TextureCache.
+// The GL textures and programs are owned here; the stored Texture2D and
+// Shader objects (and their copies) only refer to them.
 class ResourceManager
 {
 public:
   // resource storage
-  static std::map<std::string, Shader> Shaders;
-  static std::map<std::string, Texture2D> Textures;
+  static ResourceRegistry<Shader> Shaders;
+  static ResourceRegistry<Texture2D> Textures;
+  // directory loose assets are read from, the source tree's Glitter directory by default
+  static std::string AssetRoot;
+  // mounted asset pack, if any
+  static AssetPack Pack;
+  // mounts an asset pack, returns false (and keeps reading loose files) if it can't be opened
+  static bool MountPack(const char *file);
+  // queued textures and levels are loaded on worker threads, otherwise they're loaded
+  // on demand while finishing (the serial baseline)
+  static bool ParallelLoading;
   // loads (and generates) a shader program from file loading vertex, fragment (and geometry) shader's source code. If gShaderFile is not nullptr, it also loads a geometry shader
-  static Shader &LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name);
+  // defines (e.g. "#define CHAOS\n") are inserted into every stage, to build variants of the same shader files
+  static Shader &LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name,
+                            const std::string &defines = std::string());
+  // resolves a shader's handle by name (or HashName of it), an empty shader is registered under names not loaded yet
+  static ShaderHandle GetShaderHandle(const std::string &name);
+  static ShaderHandle GetShaderHandle(unsigned long long nameHash);
   // retrieves a stored sader
-  static Shader &GetShader(std::string name);
+  static Shader &GetShader(ShaderHandle handle) { return Shaders.Get(handle); }
+  static Shader &GetShader(const std::string &name);
   // loads (and generates) a texture from file
   static Texture2D &LoadTexture(const char *file, bool alpha, std::string name);
+  // resolves a texture's handle by name (or HashName of it), an empty texture is registered under names not loaded yet
+  static TextureHandle GetTextureHandle(const std::string &name);
+  static TextureHandle GetTextureHandle(unsigned long long nameHash);
   // retrieves a stored texture
-  static Texture2D &GetTexture(std::string name);
-  // properly de-allocates all loaded resources
+  static Texture2D &GetTexture(TextureHandle handle) { return Textures.Get(handle); }
+  static Texture2D &GetTexture(const std::string &name);
+  // decodes an image without generating a texture (e.g. for SoftwareRenderer): RGBA texels if
+  // alpha, RGB otherwise, rows top to bottom as drawn; returns false if it can't be read
+  static bool LoadImage(const char *file, bool alpha, std::vector<unsigned char> &texels,
+                        unsigned int &width, unsigned int &height);
+  // starts decoding a texture, it is generated and stored by FinishTextures
+  static void QueueTexture(const char *file, bool alpha, std::string name);
+  // generates and stores every queued texture, in the order their decodes complete
+  static void FinishTextures();
+  // starts reading and compiling a level, picked up by LoadLevel
+  static void QueueLevel(const char *file);
+  // reloads the shaders and textures loaded from an asset (e.g. a file changed on disk) in place: handles
+  // and GL object names stay the same. Names of recompiled shaders are added to reloadedShaders, their
+  // uniforms have to be set again. Returns false if nothing was loaded from the asset.
+  static bool ReloadAsset(const std::string &file, std::vector<std::string> &reloadedShaders);
+  // loads a level's template, or returns the one already loaded at that size: every session
+  // of the level shares it (levels are only loaded on the main thread). A level without bricks
+  // (e.g. a missing file) isn't kept
+  static std::shared_ptr<const LevelTemplate> LoadLevel(const char *file, unsigned int levelWidth, unsigned int levelHeight);
+  // properly de-allocates all loaded resources, stored textures and shaders become empty
   static void Clear();
 
 private:
+  // a decoded texture waiting to be generated
+  struct TextureImage
+  {
+    std::string Name;
+    bool Alpha;
+    int Width, Height;
+    // texels, either a view into the asset pack or the texture cache, or owned stb_image data
+    const unsigned char *Pixels;
+    bool Owned;
+    // keeps a texture cache entry mapped until the texture is generated
+    std::shared_ptr<MappedFile> CacheEntry;
+  };
+  // a level in the compiled format, either a view into the asset pack or compiled from disk
+  struct LevelImage
+  {
+    const unsigned char *View;
+    size_t ViewSize;
+    std::vector<unsigned char> Compiled;
+  };
+  // asset files of loaded shaders and textures by resource name, for reloads
+  struct ShaderFiles
+  {
+    std::string Vertex, Fragment, Geometry, Defines;
+  };
+  struct TextureFile
+  {
+    std::string File;
+    bool Alpha;
+    TextureFile() : Alpha(false) {}
+    TextureFile(const std::string &file, bool alpha) : File(file), Alpha(alpha) {}
+  };
+  static std::map<std::string, ShaderFiles> shaderFiles;
+  static std::map<std::string, TextureFile> textureFiles;
+  // owners of the GL objects of stored textures and shaders, by registry key
+  static std::unordered_map<unsigned long long, GLObject> textureObjects;
+  static std::unordered_map<unsigned long long, GLObject> programObjects;
+  // queued work
+  static std::vector<std::future<TextureImage>> pendingTextures;
+  static std::map<std::string, std::future<LevelImage>> pendingLevels;
+  // loaded level templates by file and level size
+  typedef std::map<std::tuple<std::string, unsigned int, unsigned int>, std::shared_ptr<const LevelTemplate>> LevelTemplates;
+  static LevelTemplates levelTemplates;
   // private constructor, that is we do not want any actual resource manager objects. Its members and functions should be publicly available (static).
   ResourceManager() {}
   // loads and generates a shader from file
-  static Shader loadShaderFromFile(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile = nullptr);
+  static Shader loadShaderFromFile(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile = nullptr,
+                                   const std::string &defines = std::string());
   // loads a single texture from file
-  static Texture2D loadTextureFromFile(const char *file, bool alpha);
+  static Texture2D loadTextureFromFile(const char *file, bool alpha, GLObject &object);
+  // decodes a texture (thread-safe, no GL calls)
+  static TextureImage decodeTexture(std::string file, bool alpha, std::string name);
+  // generates texture from decoded texels into the GL texture owned by object (allocated if
+  // empty) and releases them
+  static void generateTexture(TextureImage &image, Texture2D &texture, GLObject &object);
+  // reads a level and compiles it if it's a text level (thread-safe, no GL calls)
+  static LevelImage compileLevel(std::string file);
+  // registry key of a resource name
+  static unsigned long long nameHash(const std::string &name);
+  // path of a loose asset, absolute paths are used as they are
+  static std::string resolvePath(const char *file);
 };
 
 #endif
\ No newline at end of file
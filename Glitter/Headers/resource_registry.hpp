@@ -0,0 +1,99 @@
+#ifndef RESOURCE_REGISTRY_HPP
+#define RESOURCE_REGISTRY_HPP
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Typed, generation-checked index of a resource in a ResourceRegistry. Handles are
+// resolved from a name once (at load time) and then resolve to their resource with
+// an array index. A default constructed handle is invalid.
+template <typename T>
+struct ResourceHandle
+{
+  uint32_t Index;
+  uint32_t Generation;
+
+  ResourceHandle() : Index(0), Generation(0) {}
+  ResourceHandle(uint32_t index, uint32_t generation) : Index(index), Generation(generation) {}
+  bool Valid() const { return Index != 0; }
+  bool operator==(const ResourceHandle &other) const { return Index == other.Index && Generation == other.Generation; }
+  bool operator!=(const ResourceHandle &other) const { return !(*this == other); }
+};
+
+// A flat array of resources addressed by handles, with a name (hash) index used to
+// resolve handles. Slot 0 holds an empty resource that invalid and stale handles
+// resolve to. Replacing a named resource keeps its handle valid; clearing the
+// registry bumps every slot's generation so older handles go stale.
+template <typename T>
+class ResourceRegistry
+{
+public:
+  ResourceRegistry() : slots(1), generations(1, 0) {}
+
+  // stores resource under a name hash, replacing what was stored there
+  ResourceHandle<T> Set(uint64_t name, const T &resource)
+  {
+    ResourceHandle<T> handle = Find(name);
+    if (!handle.Valid())
+    {
+      uint32_t index;
+      if (!freeSlots.empty())
+      {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+      }
+      else
+      {
+        index = static_cast<uint32_t>(slots.size());
+        slots.push_back(T());
+        generations.push_back(1);
+      }
+      names[name] = index;
+      handle = ResourceHandle<T>(index, generations[index]);
+    }
+    slots[handle.Index] = resource;
+    return handle;
+  }
+  // handle of the resource stored under a name hash, invalid if there is none
+  ResourceHandle<T> Find(uint64_t name) const
+  {
+    typename std::unordered_map<uint64_t, uint32_t>::const_iterator iter = names.find(name);
+    if (iter == names.end())
+      return ResourceHandle<T>();
+    return ResourceHandle<T>(iter->second, generations[iter->second]);
+  }
+  // whether a handle refers to a stored resource
+  bool Contains(ResourceHandle<T> handle) const
+  {
+    return handle.Valid() && handle.Index < slots.size() && generations[handle.Index] == handle.Generation;
+  }
+  // resource of a handle, the empty resource for invalid or stale handles
+  T &Get(ResourceHandle<T> handle)
+  {
+    return Contains(handle) ? slots[handle.Index] : slots[0];
+  }
+  // removes every resource (the caller releases them first), all handles go stale
+  void Clear()
+  {
+    freeSlots.clear();
+    for (uint32_t i = static_cast<uint32_t>(slots.size()) - 1; i > 0; --i)
+    {
+      slots[i] = T();
+      generations[i]++;
+      freeSlots.push_back(i);
+    }
+    slots[0] = T();
+    names.clear();
+  }
+  // every slot, including the empty one and freed ones (whose resources are empty)
+  std::vector<T> &Slots() { return slots; }
+
+private:
+  std::vector<T> slots;
+  std::vector<uint32_t> generations;
+  std::vector<uint32_t> freeSlots;
+  std::unordered_map<uint64_t, uint32_t> names;
+};
+
+#endif // RESOURCE_REGISTRY_HPP
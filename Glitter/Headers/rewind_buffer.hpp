@@ -0,0 +1,68 @@
+#ifndef REWIND_BUFFER_HPP
+#define REWIND_BUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "game.hpp"
+
+// RewindBuffer keeps the recent history of a Game, one GameSnapshot per tick, within
+// a memory budget. Every keyframeInterval ticks it stores a whole snapshot (a keyframe),
+// every other tick only what changed since the tick before: the bricks that flipped,
+// as indices, and the changed words of the paddle, ball, effect, RNG and power-up
+// state. Seeking decodes forward from the nearest keyframe before the tick, so
+// scrubbing in either direction never re-simulates. The oldest keyframe and its
+// deltas are dropped once the history is longer than maxTicks or larger than maxBytes.
+class RewindBuffer
+{
+public:
+  RewindBuffer(unsigned int maxTicks, size_t maxBytes, unsigned int keyframeInterval = 60);
+  // records the game's state after a tick; after a Seek, the ticks past the seeked one are
+  // dropped first, so playing on from an earlier tick starts a new history there. States
+  // that don't fit a GameSnapshot (see Game::FitsSnapshot) aren't recorded, which is
+  // reported once
+  bool Push(const Game &game);
+  // restores tick (First() <= tick <= Last()) into game
+  bool Seek(Game &game, unsigned int tick);
+  void Clear();
+
+  // ticks are numbered from the first Push after construction or Clear
+  bool Empty() const { return segments.empty(); }
+  unsigned int First() const;
+  unsigned int Last() const;
+  // the tick game was left at by the last Push or Seek
+  unsigned int Position() const { return position; }
+  // memory held by the history
+  size_t Bytes() const;
+
+private:
+  // a keyframe and the deltas of the ticks after it, Offsets[i] is where tick FirstTick + i starts
+  struct Segment
+  {
+    unsigned int FirstTick;
+    std::vector<unsigned char> Data;
+    std::vector<uint32_t> Offsets;
+  };
+  std::deque<Segment> segments;
+  // storage of the last dropped segment, reused by the next keyframe
+  Segment spare;
+  unsigned int maxTicks;
+  size_t maxBytes;
+  unsigned int keyframeInterval;
+  unsigned int position;
+  // whether a state that didn't fit was reported
+  bool overflowReported;
+  // the state at position, what the next delta is taken against, and the state being pushed
+  GameSnapshot last, current;
+
+  void truncate();
+  void evict();
+  void encodeKeyframe(std::vector<unsigned char> &data) const;
+  void encodeDelta(std::vector<unsigned char> &data) const;
+  void decodeKeyframe(const unsigned char *data);
+  void decodeDelta(const unsigned char *data);
+};
+
+#endif // REWIND_BUFFER_HPP
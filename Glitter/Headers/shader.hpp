@@ -9,18 +9,23 @@
 
 // General purpose shader object. Compiles from file, generates
 // compile/link-time error messages and hosts several utility
-// functions for easy management.
+// functions for easy management. Like Texture2D a Shader is a cheap
+// handle, the program is owned by a GLObject (see ResourceManager).
 class Shader
 {
 public:
   // state
   unsigned int ID;
   // constructor
-  Shader() {}
+  Shader() : ID(0) {}
   // sets the current shader as active
   Shader &Use();
   // compiles the shader from given source code
   void Compile(const char *vertexSource, const char *fragmentSource, const char *geometrySource = nullptr); // note: geometry source code is optional
+  // recompiles the program from new source code in place: the ID stays the same, so every copy of this
+  // shader picks up the new program. If the new code doesn't compile or link the program is left as it
+  // was and false is returned. Uniforms are reset and have to be set again.
+  bool Recompile(const char *vertexSource, const char *fragmentSource, const char *geometrySource = nullptr);
   // utility functions
   void SetFloat(const char *name, float value, bool useShader = false);
   void SetInteger(const char *name, int value, bool useShader = false);
@@ -34,7 +39,9 @@ public:
 
 private:
   // checks if compilation or linking failed and if so, print the error logs
-  void checkCompileErrors(unsigned int object, std::string type);
+  bool checkCompileErrors(unsigned int object, std::string type);
+  // compiles a single shader stage, 0 if it fails to compile
+  unsigned int compileStage(GLenum stage, const char *source, std::string type);
 };
 
 #endif
\ No newline at end of file
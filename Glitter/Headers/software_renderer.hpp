@@ -0,0 +1,110 @@
+#ifndef SOFTWARE_RENDERER_HPP
+#define SOFTWARE_RENDERER_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Output tiles are square, SOFTWARE_TILE_SIZE pixels on a side
+const unsigned int SOFTWARE_TILE_SIZE = 32;
+
+// SoftwareRenderer draws the scene on the CPU at a small resolution (e.g. 84x84 for
+// pixel observations), without any GL context. It handles what SpriteRenderer and
+// ParticleGenerator draw: axis-aligned textured quads tinted by a color (alpha
+// blended), and particles (blended additively). A frame is recorded between Begin
+// and Finish; Finish rasterizes it tile by tile, spread over worker threads. Quads
+// cover the pixels whose centers they contain, like GL's rasterization.
+// Sprites are resampled once per texture, pixel size and color (box filtered and
+// premultiplied) and cached, so drawing one is a blend of whole rows of texels:
+// opaque rows are copied, the others are blended 4 pixels at a time with SSE2.
+class SoftwareRenderer
+{
+public:
+  // renders a sceneWidth x sceneHeight scene (the game's coordinates) into a width x height
+  // image, with threads threads (0 picks one per core)
+  SoftwareRenderer(unsigned int width, unsigned int height, unsigned int sceneWidth, unsigned int sceneHeight,
+                   unsigned int threads = 1);
+  ~SoftwareRenderer();
+  // decodes an image (see ResourceManager::LoadImage) into the texture slot, returns false
+  // if it can't be read
+  bool LoadTexture(unsigned int texture, const char *file, bool alpha);
+  // fills the texture slot from texels in memory, rows top to bottom, 3 or 4 channels
+  void SetTexture(unsigned int texture, unsigned int width, unsigned int height, unsigned int channels,
+                  const unsigned char *texels);
+
+  // starts a frame cleared to black
+  void Begin();
+  // alpha blended quad, like SpriteRenderer::DrawSprite without rotation
+  void DrawSprite(unsigned int texture, glm::vec2 position, glm::vec2 size, glm::vec3 color = glm::vec3(1.0f));
+  // additive quad, like a particle drawn by ParticleGenerator
+  void DrawParticle(unsigned int texture, glm::vec2 position, glm::vec2 size, glm::vec4 color);
+  // rasterizes the frame
+  void Finish();
+
+  unsigned int Width() const { return width; }
+  unsigned int Height() const { return height; }
+  // the last finished frame, RGB, rows top to bottom
+  const uint8_t *Pixels() const { return pixels.data(); }
+  // sprites resampled so far
+  size_t CachedSprites() const { return sprites.size(); }
+
+private:
+  // a texture as loaded, RGBA texels (3 channel images get an alpha of 255)
+  struct Texture
+  {
+    unsigned int Width, Height;
+    std::vector<uint8_t> Texels;
+  };
+  // a texture resampled to a sprite's size in pixels and tinted, premultiplied RGBA
+  struct Sprite
+  {
+    int Width, Height;
+    bool Opaque;
+    std::vector<uint8_t> Texels;
+  };
+  // a recorded quad, in pixels: rows [Top, Bottom) of columns [Left, Right) before
+  // clipping, Sprite's texel (0, 0) lands at (Left, Top)
+  struct Quad
+  {
+    int Left, Top, Right, Bottom;
+    const Sprite *Image;
+    // additive quads scale the sprite by the particle's color times its alpha
+    bool Additive;
+    uint16_t Scale[3];
+  };
+
+  unsigned int width, height;
+  float scaleX, scaleY;
+  unsigned int tilesX, tilesY;
+  std::vector<Texture> textures;
+  std::unordered_map<uint64_t, Sprite> sprites;
+  std::vector<Quad> quads;
+  // the frame being rasterized, RGBA, and the finished one, RGB
+  std::vector<uint8_t> color, pixels;
+
+  // workers rasterize the tiles of their range each time generation changes, the
+  // calling thread rasterizes range 0
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable started, finished;
+  unsigned int generation, running;
+  bool stopping;
+  void work(unsigned int range);
+  void drawRange(unsigned int range);
+  void drawTile(unsigned int tile);
+
+  // the texture resampled to width x height pixels and tinted by color
+  const Sprite &sprite(unsigned int texture, int width, int height, glm::vec3 color);
+  // records a quad covering the pixels whose centers are inside it, false if it covers none
+  bool cover(glm::vec2 position, glm::vec2 size, Quad &quad) const;
+
+  SoftwareRenderer(const SoftwareRenderer &);
+  SoftwareRenderer &operator=(const SoftwareRenderer &);
+};
+
+#endif // SOFTWARE_RENDERER_HPP
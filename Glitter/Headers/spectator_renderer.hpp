@@ -0,0 +1,101 @@
+#ifndef SPECTATOR_RENDERER_HPP
+#define SPECTATOR_RENDERER_HPP
+
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "gl_object.hpp"
+#include "shader.hpp"
+#include "texture.hpp"
+
+// SpectatorRenderer draws many game sessions side by side in a grid of tiles (a
+// spectator wall), e.g. to watch a VecEnv's sessions. Sessions add their sprites to
+// their tile (see Game::Render(SpectatorRenderer &, unsigned int, float)), which
+// scales, offsets and clips them into place. Finish uploads the instances of every
+// tile into one buffer and draws the instances of each texture with one instanced
+// draw call, so a wall takes about a dozen draws however many sessions it shows.
+// Textures are drawn in the order they were first used in the frame, which is the
+// scene's order since every session draws the same way.
+// Tiles narrower than DetailWidth pixels skip particles and effects. Wider tiles show
+// confuse (the tile is flipped and inverted) and shake (the tile jitters); chaos
+// needs a pass over the tile's pixels and isn't shown.
+class SpectatorRenderer
+{
+public:
+  // tiles narrower than this (in pixels) get no particles or effects
+  float DetailWidth;
+
+  // a width x height wall of sceneWidth x sceneHeight scenes, drawn with the spectator shader
+  SpectatorRenderer(Shader shader, unsigned int width, unsigned int height, unsigned int sceneWidth,
+                    unsigned int sceneHeight);
+  // arranges sessions tiles in the grid that makes them largest (tiles keep the scene's aspect)
+  void SetLayout(unsigned int sessions);
+  // the texture drawn for a texture slot, see Game::SetSpectatorTextures
+  void SetTexture(unsigned int texture, const Texture2D &image);
+
+  // starts a frame
+  void Begin();
+  // whether tiles are large enough for particles and effects
+  bool Detailed() const { return tileSize.x >= DetailWidth; }
+  // the tile's effects for this frame, set before drawing into it: confuse flips and
+  // inverts the tile, shake jitters it with time (both only on detailed tiles)
+  void SetEffects(unsigned int tile, bool confuse, bool shake, float time);
+  // alpha blended sprite in scene coordinates, like SpriteRenderer::DrawSprite without rotation
+  void DrawSprite(unsigned int tile, unsigned int texture, glm::vec2 position, glm::vec2 size,
+                  glm::vec3 color = glm::vec3(1.0f));
+  // additive sprite, like a particle drawn by ParticleGenerator
+  void DrawParticle(unsigned int tile, unsigned int texture, glm::vec2 position, glm::vec2 size, glm::vec4 color);
+  // draws the frame
+  void Finish();
+
+  unsigned int Tiles() const { return static_cast<unsigned int>(tiles.size()); }
+  unsigned int Columns() const { return columns; }
+  // instances drawn by the last Finish
+  size_t Instances() const { return uploaded.size(); }
+
+private:
+  // one sprite on the wall: its rectangle (x, y, width, height), the texture coordinates
+  // of its corners (u0, v0, u1, v1) and its color
+  struct Instance
+  {
+    glm::vec4 Rect, TexRect, Color;
+  };
+  // the instances of one texture, blended alike
+  struct Batch
+  {
+    std::vector<Instance> Instances;
+    bool Used;
+    Batch() : Used(false) {}
+  };
+  // where a tile is, how far it's shaken this frame and how confuse turns it
+  struct Tile
+  {
+    glm::vec2 Origin, Offset;
+    bool Flip, Invert;
+  };
+
+  Shader shader;
+  unsigned int width, height;
+  glm::vec2 sceneSize, tileSize;
+  unsigned int columns;
+  std::vector<Tile> tiles;
+  std::vector<Texture2D> textures;
+  // batches by texture slot, alpha blended ones at even and additive ones at odd indices,
+  // and the batches in the order they were first used
+  std::vector<Batch> batches;
+  std::vector<unsigned int> order;
+  // every instance of the frame as uploaded, and the index of each ordered batch's first
+  std::vector<Instance> uploaded;
+  std::vector<size_t> firsts;
+  GLObject quadVAO, quadVBO, instanceVBO, whiteTexture;
+  Texture2D white;
+
+  void add(unsigned int tile, unsigned int batch, glm::vec2 position, glm::vec2 size, glm::vec4 color);
+  // points the instance attributes at the instance with the given index
+  void bindInstances(size_t first);
+  void initRenderData();
+};
+
+#endif // SPECTATOR_RENDERER_HPP
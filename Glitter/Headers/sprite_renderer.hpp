@@ -3,6 +3,7 @@
 
 #include <glad/glad.h>
 
+#include "gl_object.hpp"
 #include "shader.hpp"
 #include "texture.hpp"
 
@@ -10,15 +11,14 @@ class SpriteRenderer
 {
 public:
   SpriteRenderer(Shader &shader);
-  ~SpriteRenderer();
 
-  void DrawSprite(Texture2D &texture, glm::vec2 position,
-                  glm::vec2 size = glm::vec2(10.0f, 10.0f), float rotate = 0.0f,
-                  glm::vec3 color = glm::vec3(1.0f));
+  void DrawSprite(const Texture2D &texture, glm::vec2 position,
+                        glm::vec2 size = glm::vec2(10.0f, 10.0f), float rotate = 0.0f,
+                        glm::vec3 color = glm::vec3(1.0f));
 
 private:
   Shader shader;
-  unsigned int quadVAO;
+  GLObject quadVAO, quadVBO;
 
   void initRenderData();
 };
@@ -0,0 +1,27 @@
+#ifndef STARTUP_TIMELINE_HPP
+#define STARTUP_TIMELINE_HPP
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// A static record of startup milestones (window created, shaders compiled, textures
+// uploaded, first frame presented, ...) timed from Begin(), printed once the first
+// frame is up to compare time-to-first-frame between loading strategies.
+class StartupTimeline
+{
+public:
+  // starts the timeline, milestones are timed relative to this call
+  static void Begin();
+  // records a milestone
+  static void Mark(const char *milestone);
+  // prints every milestone with its time since Begin and since the previous milestone
+  static void Print();
+
+private:
+  StartupTimeline() {}
+  static std::chrono::steady_clock::time_point start;
+  static std::vector<std::pair<std::string, double>> milestones;
+};
+
+#endif // STARTUP_TIMELINE_HPP
@@ -4,7 +4,9 @@
 #include <glad/glad.h>
 
 // Texture2D is able to store and configure a texture in OpenGL.
-// It also hosts utility functions for easy management.
+// It also hosts utility functions for easy management. A Texture2D
+// doesn't own its GL texture (a GLObject does), so copies are cheap
+// and default-constructed textures need no GL context.
 class Texture2D
 {
 public:
@@ -22,8 +24,8 @@ public:
   unsigned int Filter_Max; // filtering mode if texture pixels > screen pixels
   // constructor (sets default texture modes)
   Texture2D();
-  // generates texture from image data
-  void Generate(unsigned int width, unsigned int height, unsigned char *data);
+  // generates texture from image data into the texture named by ID
+  void Generate(unsigned int width, unsigned int height, const unsigned char *data);
   // binds the texture as the current active GL_TEXTURE_2D texture object
   void Bind() const;
 };
@@ -0,0 +1,55 @@
+#ifndef TEXTURE_CACHE_HPP
+#define TEXTURE_CACHE_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "mapped_file.hpp"
+
+// An on-disk cache of decoded texture images, so JPEG/PNG files are only decoded
+// once instead of on every launch. Every source image gets one cache file named
+// after the hash of its path:
+//
+//   TextureCacheHeader | texels (Width * Height * Channels bytes, rows top to bottom as stb_image decodes them)
+//
+// An entry is valid while the source keeps the size and modification time it had
+// when the entry was written. If only the modification time changed, the source is
+// hashed and compared to the stored content hash before the entry is thrown away.
+const char TEXTURE_CACHE_MAGIC[4] = {'B', 'T', 'E', 'X'};
+const uint32_t TEXTURE_CACHE_VERSION = 1;
+
+struct TextureCacheHeader
+{
+  char Magic[4];
+  uint32_t Version;
+  uint32_t Width, Height, Channels;
+  uint32_t Reserved;
+  // the source image the texels were decoded from
+  uint64_t SourceSize;
+  int64_t SourceModified;
+  uint64_t SourceHash;
+};
+
+// A static singleton that reads and writes the texture cache. All functions are
+// thread-safe, they only touch the cache file of the given source.
+class TextureCache
+{
+public:
+  // directory cache files are kept in, caching is off while it's empty
+  static std::string Directory;
+  // turns caching on, creating the cache directory if needed
+  static bool Enable(const std::string &directory);
+  // maps the cache entry of a source image, returns its header if the entry is valid
+  // (the texels follow it), nullptr if it's missing or stale
+  static const TextureCacheHeader *Load(const std::string &source, MappedFile &entry);
+  // writes the cache entry of a source image from its decoded texels
+  static bool Store(const std::string &source, unsigned int width, unsigned int height,
+                    unsigned int channels, const unsigned char *texels);
+
+private:
+  TextureCache() {}
+  // path of the cache file for a source image
+  static std::string entryPath(const std::string &source);
+};
+
+#endif // TEXTURE_CACHE_HPP
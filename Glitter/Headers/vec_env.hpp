@@ -0,0 +1,105 @@
+#ifndef VEC_ENV_HPP
+#define VEC_ENV_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "game.hpp"
+
+// Actions a policy picks from, one per session and step
+enum EnvAction
+{
+  ACTION_NONE,
+  ACTION_LEFT,
+  ACTION_RIGHT,
+  ACTION_LAUNCH,
+  ACTIONS
+};
+
+// Observation layout, floats per session: paddle, ball (its position is the top-left
+// corner of its bounds), then the time left of each power-up type while it's active
+// (0 when it isn't), indexed by PowerUpType
+enum EnvObservation
+{
+  OBS_PADDLE_X,
+  OBS_PADDLE_WIDTH,
+  OBS_BALL_X,
+  OBS_BALL_Y,
+  OBS_BALL_RADIUS,
+  OBS_BALL_VELOCITY_X,
+  OBS_BALL_VELOCITY_Y,
+  OBS_BALL_STUCK,
+  OBS_POWER_UPS,
+  OBS_FLOATS = OBS_POWER_UPS + POWER_UP_TYPES
+};
+
+// VecEnv steps a batch of headless Game sessions in lockstep, for training control
+// policies. Each Step feeds every session its action through ProcessInput, advances
+// it one fixed tick with Update and writes observations, rewards and dones into
+// buffers allocated once up front. Sessions are split into contiguous ranges, one per
+// worker thread. A session that loses its ball or clears its level is done; it is
+// reset to its starting snapshot for the next step, with a fresh spawn seed.
+class VecEnv
+{
+public:
+  // reward per destroyed brick and per lost ball
+  float BrickReward, BallLostPenalty;
+
+  // sessions of the given level seeded from seed, stepped by threads threads (0 picks
+  // one per core); needs the level loaded on the calling thread, like Game::InitHeadless.
+  // There are no sessions if the game has no such level
+  VecEnv(unsigned int sessions, unsigned int level = 0, unsigned int seed = 1, unsigned int threads = 0,
+         float dt = 1.0f / 60.0f);
+  ~VecEnv();
+  // steps every session with actions[session] (EnvAction values)
+  void Step(const uint8_t *actions);
+  // resets every session to the start of an episode and writes their observations
+  void Reset();
+  // whether the sessions update their particles: off by default as nobody sees them, on
+  // when they're watched (e.g. on a spectator wall large enough to show particles)
+  void SetParticles(bool particles);
+
+  unsigned int Sessions() const { return static_cast<unsigned int>(games.size()); }
+  // OBS_FLOATS floats per session
+  const float *Observations() const { return observations.data(); }
+  // the level's destroyed-brick bits (see GameLevel::Destroyed), BrickBytes() per session
+  const uint8_t *Bricks() const { return bricks.data(); }
+  unsigned int BrickBytes() const { return brickBytes; }
+  const float *Rewards() const { return rewards.data(); }
+  const uint8_t *Dones() const { return dones.data(); }
+  // the session itself, e.g. to render or hash it
+  const Game &Session(unsigned int session) const { return *games[session]; }
+
+private:
+  std::vector<std::unique_ptr<Game>> games;
+  // state every episode starts from, and episodes played per session (mixed into the seed)
+  GameSnapshot start;
+  std::vector<unsigned int> episodes;
+  unsigned int seed;
+  float dt;
+  unsigned int brickBytes;
+  std::vector<float> observations, rewards;
+  std::vector<uint8_t> bricks, dones;
+
+  // workers step sessions [first, last) of their range each time generation changes,
+  // the calling thread steps range 0
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable started, finished;
+  unsigned int generation, running;
+  bool stopping;
+  const uint8_t *actions;
+  void work(unsigned int range);
+  void stepRange(unsigned int range);
+  void resetSession(unsigned int session);
+  void observe(unsigned int session);
+
+  VecEnv(const VecEnv &);
+  VecEnv &operator=(const VecEnv &);
+};
+
+#endif // VEC_ENV_HPP
@@ -3,37 +3,78 @@ in vec2 TexCoords;
 out vec4 color;
 
 uniform sampler2D scene;
+
+// chaos wins over confuse, which wins over shake; only the kernel of the
+// effect that runs is declared and sampled
+#if defined(CHAOS)
 uniform vec2 offsets[9];
 uniform int edge_kernel[9];
+#elif !defined(CONFUSE) && defined(SHAKE)
+uniform vec2 offsets[9];
 uniform float blur_kernel[9];
+#endif
+
+#if defined(FXAA)
+uniform vec2 inverseSize; // size of a scene texel
+
+// FXAA (the compact variant of Timothy Lottes' filter): blurs along the edge
+// direction found from the luma of the four diagonal neighbours
+vec3 fxaa(vec2 uv) {
+  const float spanMax = 8.0;
+  const float reduceMul = 1.0 / 8.0;
+  const float reduceMin = 1.0 / 128.0;
+  const vec3 lumaWeights = vec3(0.299, 0.587, 0.114);
+  vec3 rgbM = texture(scene, uv).rgb;
+  float lumaNW = dot(texture(scene, uv + vec2(-1.0, -1.0) * inverseSize).rgb, lumaWeights);
+  float lumaNE = dot(texture(scene, uv + vec2(1.0, -1.0) * inverseSize).rgb, lumaWeights);
+  float lumaSW = dot(texture(scene, uv + vec2(-1.0, 1.0) * inverseSize).rgb, lumaWeights);
+  float lumaSE = dot(texture(scene, uv + vec2(1.0, 1.0) * inverseSize).rgb, lumaWeights);
+  float lumaM = dot(rgbM, lumaWeights);
+  float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+  float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+
+  vec2 dir = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)), (lumaNW + lumaSW) - (lumaNE + lumaSE));
+  float dirReduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * 0.25 * reduceMul, reduceMin);
+  float rcpDirMin = 1.0 / (min(abs(dir.x), abs(dir.y)) + dirReduce);
+  dir = clamp(dir * rcpDirMin, vec2(-spanMax), vec2(spanMax)) * inverseSize;
+
+  vec3 rgbA = 0.5 * (texture(scene, uv + dir * (1.0 / 3.0 - 0.5)).rgb +
+                     texture(scene, uv + dir * (2.0 / 3.0 - 0.5)).rgb);
+  vec3 rgbB = rgbA * 0.5 + 0.25 * (texture(scene, uv - dir * 0.5).rgb +
+                                   texture(scene, uv + dir * 0.5).rgb);
+  float lumaB = dot(rgbB, lumaWeights);
+  return (lumaB < lumaMin || lumaB > lumaMax) ? rgbA : rgbB;
+}
+#endif
 
-uniform bool chaos;
-uniform bool confuse;
-uniform bool shake;
+// the scene's color, anti-aliased with FXAA (the kernels of chaos and shake
+// sample it directly, they smooth or outline edges anyway)
+vec3 sceneColor(vec2 uv) {
+#if defined(FXAA)
+  return fxaa(uv);
+#else
+  return texture(scene, uv).rgb;
+#endif
+}
 
 void main() {
+#if defined(CHAOS)
   color = vec4(0.0);
-  vec3 sample[9];
-
-  if(chaos || shake) {
-    for(int i = 0; i < 9; i++) {
-      sample[i] = vec3(texture(scene, TexCoords.st + offsets[i]));
-    }
+  for(int i = 0; i < 9; i++) {
+    color += vec4(vec3(texture(scene, TexCoords.st + offsets[i])) * edge_kernel[i], 0.0);
   }
-
-  if(chaos) {
-    for(int i = 0; i < 9; i++) {
-      color += vec4(sample[i] * edge_kernel[i], 0.0);
-    }
-    color.a = 1.0;
-  } else if(confuse) {
-    color = vec4(1.0 - texture(scene, TexCoords).rgb, 1.0);
-  } else if(shake) {
-    for(int i = 0; i < 9; i++) {
-      color += vec4(sample[i] * blur_kernel[i], 0.0);
-    }
-    color.a = 1.0;
-  } else {
-    color = texture(scene, TexCoords);
+  color.a = 1.0;
+#elif defined(CONFUSE)
+  color = vec4(1.0 - sceneColor(TexCoords), 1.0);
+#elif defined(SHAKE)
+  color = vec4(0.0);
+  for(int i = 0; i < 9; i++) {
+    color += vec4(vec3(texture(scene, TexCoords.st + offsets[i])) * blur_kernel[i], 0.0);
   }
-}
+  color.a = 1.0;
+#elif defined(FXAA)
+  color = vec4(sceneColor(TexCoords), 1.0);
+#else
+  color = texture(scene, TexCoords);
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#version 330 core
+in vec2 TexCoords;
+in vec4 SpriteColor;
+out vec4 FragColor;
+
+uniform sampler2D spriteTexture;
+
+void main() {
+  FragColor = SpriteColor * texture(spriteTexture, TexCoords);
+}
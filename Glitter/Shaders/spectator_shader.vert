@@ -0,0 +1,17 @@
+#version 330 core
+layout(location = 0) in vec4 vertex; // <vec2 position, vec2 texture coordinates>
+// per instance: the sprite's rectangle on the wall, the part of its texture it shows and its color
+layout(location = 1) in vec4 rect;
+layout(location = 2) in vec4 texRect;
+layout(location = 3) in vec4 instanceColor;
+
+out vec2 TexCoords;
+out vec4 SpriteColor;
+
+uniform mat4 projection;
+
+void main() {
+  TexCoords = mix(texRect.xy, texRect.zw, vertex.zw);
+  SpriteColor = instanceColor;
+  gl_Position = projection * vec4(rect.xy + vertex.xy * rect.zw, 0.0, 1.0);
+}
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "asset_pack.hpp"
+
+bool AssetPack::Open(const char *file)
+{
+  Close();
+  if (!this->file.Open(file))
+    return false;
+  const unsigned char *data = this->file.Data();
+  size_t size = this->file.Size();
+  const AssetPackHeader *packHeader = reinterpret_cast<const AssetPackHeader *>(data);
+  if (size < sizeof(AssetPackHeader) ||
+      std::memcmp(packHeader->Magic, ASSET_PACK_MAGIC, sizeof(ASSET_PACK_MAGIC)) != 0 ||
+      packHeader->Version != ASSET_PACK_VERSION ||
+      sizeof(AssetPackHeader) + packHeader->EntryCount * sizeof(AssetPackEntry) > size)
+  {
+    std::cerr << "ERROR::ASSET_PACK::OPEN::Not a valid asset pack: " << file << std::endl;
+    this->file.Close();
+    return false;
+  }
+  const AssetPackEntry *packEntries = reinterpret_cast<const AssetPackEntry *>(data + sizeof(AssetPackHeader));
+  for (unsigned int i = 0; i < packHeader->EntryCount; ++i)
+  {
+    // shaders are followed by their terminating NUL
+    uint64_t end = packEntries[i].Offset + packEntries[i].Size + (packEntries[i].Type == ASSET_SHADER);
+    if (end > size)
+    {
+      std::cerr << "ERROR::ASSET_PACK::OPEN::Truncated asset pack: " << file << std::endl;
+      this->file.Close();
+      return false;
+    }
+  }
+  header = packHeader;
+  entries = packEntries;
+  return true;
+}
+
+void AssetPack::Close()
+{
+  file.Close();
+  header = nullptr;
+  entries = nullptr;
+}
+
+const AssetPackEntry *AssetPack::Find(const char *name) const
+{
+  if (!header)
+    return nullptr;
+  // the index is sorted by name
+  const AssetPackEntry *end = entries + header->EntryCount;
+  const AssetPackEntry *entry = std::lower_bound(
+      entries, end, name, [](const AssetPackEntry &e, const char *n)
+      { return std::strncmp(e.Name, n, sizeof(e.Name)) < 0; });
+  if (entry != end && std::strncmp(entry->Name, name, sizeof(entry->Name)) == 0)
+    return entry;
+  return nullptr;
+}
+
+bool AssetPackWriter::Add(const std::string &name, AssetType type, const unsigned char *data, size_t size,
+                          unsigned int width, unsigned int height, unsigned int channels)
+{
+  Asset asset;
+  if (name.size() >= sizeof(asset.Entry.Name))
+  {
+    std::cerr << "ERROR::ASSET_PACK::ADD::Asset name too long: " << name << std::endl;
+    return false;
+  }
+  std::memset(&asset.Entry, 0, sizeof(asset.Entry));
+  std::strncpy(asset.Entry.Name, name.c_str(), sizeof(asset.Entry.Name) - 1);
+  asset.Entry.Type = type;
+  asset.Entry.Width = width;
+  asset.Entry.Height = height;
+  asset.Entry.Channels = channels;
+  asset.Entry.Size = size;
+  asset.Data.assign(data, data + size);
+  // shader sources are handed to GL as C strings straight from the mapping
+  if (type == ASSET_SHADER)
+    asset.Data.push_back('\0');
+  assets.push_back(asset);
+  return true;
+}
+
+bool AssetPackWriter::Write(const char *file)
+{
+  std::sort(assets.begin(), assets.end(), [](const Asset &a, const Asset &b)
+            { return std::strncmp(a.Entry.Name, b.Entry.Name, sizeof(a.Entry.Name)) < 0; });
+
+  // lay out the data after the index, every asset 16 byte aligned
+  uint64_t offset = sizeof(AssetPackHeader) + assets.size() * sizeof(AssetPackEntry);
+  for (Asset &asset : assets)
+  {
+    offset = (offset + 15) & ~static_cast<uint64_t>(15);
+    asset.Entry.Offset = offset;
+    offset += asset.Data.size();
+  }
+
+  AssetPackHeader header;
+  std::memcpy(header.Magic, ASSET_PACK_MAGIC, sizeof(header.Magic));
+  header.Version = ASSET_PACK_VERSION;
+  header.EntryCount = assets.size();
+  header.Reserved = 0;
+
+  std::ofstream out(file, std::ios::binary);
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  for (const Asset &asset : assets)
+    out.write(reinterpret_cast<const char *>(&asset.Entry), sizeof(asset.Entry));
+  const char padding[16] = {};
+  uint64_t position = sizeof(AssetPackHeader) + assets.size() * sizeof(AssetPackEntry);
+  for (const Asset &asset : assets)
+  {
+    out.write(padding, asset.Entry.Offset - position);
+    out.write(reinterpret_cast<const char *>(asset.Data.data()), asset.Data.size());
+    position = asset.Entry.Offset + asset.Data.size();
+  }
+  if (!out)
+  {
+    std::cerr << "ERROR::ASSET_PACK::WRITE::Failed to write asset pack: " << file << std::endl;
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <iostream>
+
+#include "asset_watcher.hpp"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+AssetWatcher::AssetWatcher()
+    : inotifyFd(-1), running(false)
+{
+}
+
+AssetWatcher::~AssetWatcher()
+{
+  Stop();
+}
+
+#ifdef __linux__
+
+bool AssetWatcher::Start(const std::string &root, const std::vector<std::string> &directories)
+{
+  Stop();
+  inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotifyFd < 0)
+  {
+    std::cout << "ERROR::ASSET_WATCHER::START::Failed to initialize inotify" << std::endl;
+    return false;
+  }
+  for (const std::string &directory : directories)
+  {
+    // editors either rewrite files in place or save to a temporary file and rename it
+    std::string path = root + "/" + directory;
+    int watch = inotify_add_watch(inotifyFd, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (watch < 0)
+      std::cout << "ERROR::ASSET_WATCHER::START::Failed to watch " << path << std::endl;
+    else
+      watches.push_back(std::make_pair(watch, directory));
+  }
+  running = true;
+  thread = std::thread(&AssetWatcher::watch, this);
+  return true;
+}
+
+void AssetWatcher::Stop()
+{
+  running = false;
+  if (thread.joinable())
+    thread.join();
+  if (inotifyFd >= 0)
+    close(inotifyFd);
+  inotifyFd = -1;
+  watches.clear();
+}
+
+void AssetWatcher::watch()
+{
+  alignas(inotify_event) char buffer[4096];
+  while (running)
+  {
+    // wake up regularly to notice Stop
+    pollfd descriptor = {inotifyFd, POLLIN, 0};
+    if (poll(&descriptor, 1, 100) <= 0)
+      continue;
+    ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+    for (ssize_t offset = 0; offset < length;)
+    {
+      const inotify_event *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+      offset += sizeof(inotify_event) + event->len;
+      if (event->len == 0)
+        continue;
+      for (const std::pair<int, std::string> &watch : watches)
+      {
+        if (watch.first != event->wd)
+          continue;
+        std::string name = watch.second + "/" + event->name;
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (std::find(queue.begin(), queue.end(), name) == queue.end())
+          queue.push_back(name);
+      }
+    }
+  }
+}
+
+#else
+
+bool AssetWatcher::Start(const std::string &, const std::vector<std::string> &)
+{
+  std::cout << "ERROR::ASSET_WATCHER::START::Watching assets needs inotify (Linux)" << std::endl;
+  return false;
+}
+
+void AssetWatcher::Stop()
+{
+}
+
+void AssetWatcher::watch()
+{
+}
+
+#endif
+
+bool AssetWatcher::Poll(std::vector<std::string> &changed)
+{
+  std::lock_guard<std::mutex> lock(queueMutex);
+  changed.insert(changed.end(), queue.begin(), queue.end());
+  queue.clear();
+  return !changed.empty();
+}
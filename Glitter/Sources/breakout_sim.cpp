@@ -0,0 +1,229 @@
+#include <cstring>
+#include <iostream>
+
+#include "breakout_sim.h"
+#include "game.hpp"
+#include "replay.hpp"
+#include "resource_manager.hpp"
+
+static_assert(BSIM_INPUT_LEFT == INPUT_LEFT && BSIM_INPUT_RIGHT == INPUT_RIGHT && BSIM_INPUT_LAUNCH == INPUT_LAUNCH,
+              "input bits are the replay's");
+static_assert(BSIM_POWER_UPS == POWER_UP_TYPES, "one time per power-up type");
+
+struct bsim_session
+{
+  Game Session;
+  bsim_session() : Session(SCREEN_WIDTH, SCREEN_HEIGHT) {}
+};
+
+// No C++ exception may leave an entry point (the caller is C, or a runtime like Python's
+// ctypes). The ones that allocate, print or run the simulation catch everything and fail
+// the way their result reports failures (void ones leave the session partly stepped);
+// the others only copy plain data and can't throw
+
+uint32_t bsim_abi_version(void)
+{
+  return BSIM_ABI_VERSION;
+}
+
+void bsim_set_asset_root(const char *path)
+{
+  try
+  {
+    ResourceManager::AssetRoot = path;
+  }
+  catch (...)
+  {
+  }
+}
+
+bsim_session *bsim_create(uint32_t seed)
+{
+  bsim_session *session = nullptr;
+  try
+  {
+    session = new bsim_session();
+    session->Session.InitHeadless();
+    // a level file that can't be read loads without bricks
+    for (const GameLevel &level : session->Session.Levels)
+    {
+      if (level.Bricks().empty())
+      {
+        std::cout << "ERROR::BSIM: The shipped levels can't be read from " << ResourceManager::AssetRoot << std::endl;
+        delete session;
+        return nullptr;
+      }
+    }
+    // nobody sees them
+    session->Session.UpdateParticles = false;
+    session->Session.SetSeed(seed);
+    return session;
+  }
+  catch (...)
+  {
+    delete session;
+    return nullptr;
+  }
+}
+
+void bsim_destroy(bsim_session *session)
+{
+  delete session;
+}
+
+int32_t bsim_load_level(bsim_session *session, const void *data, size_t size)
+{
+  try
+  {
+    Game &game = session->Session;
+    GameLevel level;
+    level.Load(static_cast<const unsigned char *>(data), size, game.Width, game.Height / 2);
+    if (level.Bricks().empty())
+      return -1;
+    game.Levels.push_back(level);
+    game.CurrentLevel = static_cast<unsigned int>(game.Levels.size() - 1);
+    return static_cast<int32_t>(game.CurrentLevel);
+  }
+  catch (...)
+  {
+    return -1;
+  }
+}
+
+int bsim_set_level(bsim_session *session, uint32_t level)
+{
+  Game &game = session->Session;
+  if (level >= game.Levels.size())
+    return 0;
+  game.CurrentLevel = level;
+  game.Levels[level].Reset();
+  return 1;
+}
+
+void bsim_step(bsim_session *session, uint32_t input, float dt)
+{
+  try
+  {
+    Game &game = session->Session;
+    game.Keys[GLFW_KEY_LEFT] = (input & BSIM_INPUT_LEFT) != 0;
+    game.Keys[GLFW_KEY_RIGHT] = (input & BSIM_INPUT_RIGHT) != 0;
+    game.Keys[GLFW_KEY_SPACE] = (input & BSIM_INPUT_LAUNCH) != 0;
+    game.ProcessInput(dt);
+    game.Update(dt);
+  }
+  catch (...)
+  {
+  }
+}
+
+void bsim_read_state(const bsim_session *session, bsim_state *state)
+{
+  const Game &game = session->Session;
+  const GameObject &player = game.GetPlayer();
+  const BallObject &ball = game.GetBall();
+  const GameLevel &level = game.Levels[game.CurrentLevel];
+  state->paddle_x = player.Position.x;
+  state->paddle_y = player.Position.y;
+  state->paddle_width = player.Size.x;
+  state->paddle_height = player.Size.y;
+  state->ball_x = ball.Position.x;
+  state->ball_y = ball.Position.y;
+  state->ball_velocity_x = ball.Velocity.x;
+  state->ball_velocity_y = ball.Velocity.y;
+  state->ball_radius = ball.Radius;
+  state->ball_stuck = ball.Stuck;
+  state->level = game.CurrentLevel;
+  state->brick_count = static_cast<uint32_t>(level.Bricks().size());
+  state->bricks_destroyed = 0;
+  for (uint8_t bits : level.Destroyed)
+  {
+    for (; bits; bits &= bits - 1)
+      state->bricks_destroyed++;
+  }
+  state->balls_lost = game.BallsLost;
+  for (unsigned int type = 0; type < POWER_UP_TYPES; ++type)
+    state->power_up_time[type] = 0.0f;
+  for (const PowerUp &powerUp : game.PowerUps)
+  {
+    if (powerUp.Activated && powerUp.Duration > state->power_up_time[powerUp.Type])
+      state->power_up_time[powerUp.Type] = powerUp.Duration;
+  }
+  state->state_hash = game.StateHash();
+}
+
+size_t bsim_read_bricks(const bsim_session *session, uint8_t *bricks, size_t capacity)
+{
+  const std::vector<uint8_t> &destroyed = session->Session.Levels[session->Session.CurrentLevel].Destroyed;
+  if (bricks && capacity >= destroyed.size())
+    std::memcpy(bricks, destroyed.data(), destroyed.size());
+  return destroyed.size();
+}
+
+size_t bsim_snapshot_size(void)
+{
+  return sizeof(GameSnapshot);
+}
+
+int bsim_save(const bsim_session *session, void *snapshot, size_t size)
+{
+  if (size < sizeof(GameSnapshot))
+    return 0;
+  try
+  {
+    // the blob may not be aligned for GameSnapshot
+    GameSnapshot saved;
+    if (!session->Session.SaveSnapshot(saved))
+      return 0;
+    std::memcpy(snapshot, &saved, sizeof(saved));
+    return 1;
+  }
+  catch (...)
+  {
+    return 0;
+  }
+}
+
+int bsim_restore(bsim_session *session, const void *snapshot, size_t size)
+{
+  if (size < sizeof(GameSnapshot))
+    return 0;
+  GameSnapshot saved;
+  std::memcpy(&saved, snapshot, sizeof(saved));
+  try
+  {
+    // grows PowerUps to the snapshot's
+    return session->Session.RestoreSnapshot(saved);
+  }
+  catch (...)
+  {
+    return 0;
+  }
+}
+
+void bsim_step_batch(bsim_session *const *sessions, const uint32_t *inputs, size_t count, float dt)
+{
+  for (size_t i = 0; i < count; ++i)
+    bsim_step(sessions[i], inputs[i], dt);
+}
+
+void bsim_read_state_batch(bsim_session *const *sessions, bsim_state *states, size_t count)
+{
+  for (size_t i = 0; i < count; ++i)
+    bsim_read_state(sessions[i], &states[i]);
+}
+
+size_t bsim_save_batch(bsim_session *const *sessions, void *snapshots, size_t count)
+{
+  size_t saved = 0;
+  for (size_t i = 0; i < count; ++i)
+    saved += bsim_save(sessions[i], static_cast<unsigned char *>(snapshots) + i * sizeof(GameSnapshot), sizeof(GameSnapshot));
+  return saved;
+}
+
+size_t bsim_restore_batch(bsim_session *const *sessions, const void *snapshots, size_t count)
+{
+  size_t restored = 0;
+  for (size_t i = 0; i < count; ++i)
+    restored += bsim_restore(sessions[i], static_cast<const unsigned char *>(snapshots) + i * sizeof(GameSnapshot), sizeof(GameSnapshot));
+  return restored;
+}
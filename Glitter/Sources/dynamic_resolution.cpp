@@ -0,0 +1,84 @@
+#include <cmath>
+
+#include <glad/glad.h>
+
+#include "dynamic_resolution.hpp"
+
+GpuTimer::GpuTimer(const char *subsystem)
+    : begun(0), read(0)
+{
+  for (GLObject &query : queries)
+    query = GLObject(GL_OBJECT_QUERY, subsystem);
+}
+
+// with every query in flight the frame goes unmeasured instead of waiting for one
+void GpuTimer::Begin()
+{
+  if (begun - read < QUERIES)
+    glBeginQuery(GL_TIME_ELAPSED, queries[begun % QUERIES].ID());
+}
+
+void GpuTimer::End()
+{
+  if (begun - read < QUERIES)
+  {
+    glEndQuery(GL_TIME_ELAPSED);
+    begun++;
+  }
+}
+
+bool GpuTimer::Result(float &milliseconds)
+{
+  bool found = false;
+  for (; read != begun; ++read)
+  {
+    GLuint query = queries[read % QUERIES].ID();
+    GLint available = 0;
+    glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+      break;
+    GLuint64 elapsed = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+    milliseconds = elapsed / 1.0e6f;
+    found = true;
+  }
+  return found;
+}
+
+// frames to skip after a change (the first ones may still have been rendered at the old scale),
+// then frames averaged per decision
+static const unsigned int SETTLE_FRAMES = 8;
+static const unsigned int MEASURED_FRAMES = 8;
+static const float SCALE_STEP = 1.0f / 16.0f;
+
+DynamicResolution::DynamicResolution(float targetMs, float minScale, float maxScale)
+    : TargetMs(targetMs), MinScale(minScale), MaxScale(maxScale), scale(maxScale), total(0.0f), samples(0)
+{
+}
+
+bool DynamicResolution::Update(float frameMs)
+{
+  samples++;
+  if (samples <= SETTLE_FRAMES)
+    return false;
+  total += frameMs;
+  if (samples < SETTLE_FRAMES + MEASURED_FRAMES)
+    return false;
+  float average = total / MEASURED_FRAMES;
+  total = 0.0f;
+  samples = SETTLE_FRAMES;
+
+  // the cost that scales is per pixel, so the scale shrinks with the square root of the overshoot.
+  // It only grows a step at a time and with enough headroom that the step can't overshoot again
+  float desired = scale;
+  if (average > TargetMs)
+    desired = std::floor(scale * std::sqrt(TargetMs / average) / SCALE_STEP) * SCALE_STEP;
+  else if (average < TargetMs * 0.75f)
+    desired = scale + SCALE_STEP;
+  desired = desired < MinScale ? MinScale : (desired > MaxScale ? MaxScale : desired);
+  if (desired == scale)
+    return false;
+  scale = desired;
+  samples = 0;
+  return true;
+}
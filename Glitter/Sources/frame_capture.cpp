@@ -0,0 +1,260 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "frame_capture.hpp"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+// frames waiting for the writer before new ones are dropped (about 60 MB at 800x600)
+static const size_t MAX_QUEUED_FRAMES = 32;
+
+FrameCapture::FrameCapture()
+    : first(0), inFlight(0), active(false), width(0), height(0), y4m(false), stream(nullptr),
+      frames(0), dropped(0), stalls(0), captureMs(0.0), stopping(false), written(0)
+{
+  for (Slot &slot : slots)
+  {
+    slot.Fence = nullptr;
+    slot.Frame = 0;
+  }
+}
+
+FrameCapture::~FrameCapture()
+{
+  Stop();
+}
+
+bool FrameCapture::Start(const std::string &path, unsigned int width, unsigned int height, unsigned int fps)
+{
+  Stop();
+  this->path = path;
+  this->width = width;
+  this->height = height;
+  y4m = path.size() > 4 && path.compare(path.size() - 4, 4, ".y4m") == 0;
+  if (y4m)
+  {
+    stream = std::fopen(path.c_str(), "wb");
+    if (!stream)
+    {
+      std::cout << "ERROR::FRAME_CAPTURE: Failed to open " << path << std::endl;
+      return false;
+    }
+    std::fprintf(stream, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C420jpeg\n", width, height, fps);
+  }
+
+  size_t size = static_cast<size_t>(width) * height * 4;
+  for (Slot &slot : slots)
+  {
+    slot.Buffer = GLObject(GL_OBJECT_BUFFER, "capture");
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.Buffer.ID());
+    glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    slot.Buffer.SetBytes(size);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  first = inFlight = 0;
+  frames = dropped = stalls = written = 0;
+  captureMs = 0.0;
+  stopping = false;
+  writer = std::thread(&FrameCapture::writeFrames, this);
+  active = true;
+  return true;
+}
+
+void FrameCapture::Capture()
+{
+  if (!active)
+    return;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  // hand every read that has finished to the writer, oldest first
+  while (inFlight > 0 && collect(slots[first], false))
+  {
+    first = (first + 1) % SLOTS;
+    inFlight--;
+  }
+  // the GPU is a whole ring behind, only now is there no way around waiting
+  if (inFlight == SLOTS)
+  {
+    stalls++;
+    collect(slots[first], true);
+    first = (first + 1) % SLOTS;
+    inFlight--;
+  }
+
+  // with a pack buffer bound the read only gets queued, like a draw call
+  Slot &slot = slots[(first + inFlight) % SLOTS];
+  slot.Frame = frames++;
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.Buffer.ID());
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  slot.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  inFlight++;
+  captureMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool FrameCapture::collect(Slot &slot, bool wait)
+{
+  GLenum status = glClientWaitSync(slot.Fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                                   wait ? 1000000000ull : 0);
+  if (status == GL_TIMEOUT_EXPIRED && !wait)
+    return false;
+  glDeleteSync(slot.Fence);
+  slot.Fence = nullptr;
+
+  std::vector<unsigned char> pixels;
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED || queue.size() >= MAX_QUEUED_FRAMES)
+    {
+      dropped++;
+      return true;
+    }
+    if (!freeBuffers.empty())
+    {
+      pixels.swap(freeBuffers.back());
+      freeBuffers.pop_back();
+    }
+  }
+  size_t size = static_cast<size_t>(width) * height * 4;
+  pixels.resize(size);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.Buffer.ID());
+  const void *data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+  if (data)
+    std::memcpy(pixels.data(), data, size);
+  glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  std::lock_guard<std::mutex> lock(queueMutex);
+  if (!data)
+  {
+    dropped++;
+    freeBuffers.push_back(std::move(pixels));
+    return true;
+  }
+  queue.push_back(std::make_pair(slot.Frame, std::move(pixels)));
+  queueChanged.notify_one();
+  return true;
+}
+
+void FrameCapture::Stop()
+{
+  if (!active)
+    return;
+  while (inFlight > 0)
+  {
+    collect(slots[first], true);
+    first = (first + 1) % SLOTS;
+    inFlight--;
+  }
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    stopping = true;
+  }
+  queueChanged.notify_one();
+  writer.join();
+
+  for (Slot &slot : slots)
+    slot.Buffer.Reset();
+  if (stream)
+    std::fclose(stream);
+  stream = nullptr;
+  freeBuffers.clear();
+  active = false;
+  std::cout << "capture: " << written << " of " << frames << " frames written to " << path << " ("
+            << dropped << " dropped, waited for the GPU " << stalls << " times, "
+            << (frames ? captureMs / frames : 0.0) << " ms per frame on the render thread)" << std::endl;
+}
+
+void FrameCapture::writeFrames()
+{
+  std::vector<unsigned char> converted;
+  for (;;)
+  {
+    std::pair<unsigned int, std::vector<unsigned char>> frame;
+    {
+      std::unique_lock<std::mutex> lock(queueMutex);
+      while (!stopping && queue.empty())
+        queueChanged.wait(lock);
+      if (queue.empty())
+        return;
+      frame = std::move(queue.front());
+      queue.pop_front();
+    }
+    bool ok = y4m ? writeY4m(frame.second, converted) : writePng(frame.first, frame.second, converted);
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (ok)
+      written++;
+    freeBuffers.push_back(std::move(frame.second));
+  }
+}
+
+// GL rows go bottom up, image rows top down
+bool FrameCapture::writePng(unsigned int frame, const std::vector<unsigned char> &pixels, std::vector<unsigned char> &rgb)
+{
+  rgb.resize(static_cast<size_t>(width) * height * 3);
+  for (unsigned int y = 0; y < height; ++y)
+  {
+    const unsigned char *source = &pixels[static_cast<size_t>(height - 1 - y) * width * 4];
+    unsigned char *destination = &rgb[static_cast<size_t>(y) * width * 3];
+    for (unsigned int x = 0; x < width; ++x)
+      std::memcpy(destination + x * 3, source + x * 4, 3);
+  }
+  char number[16];
+  std::snprintf(number, sizeof(number), "%06u.png", frame);
+  std::string file = path + number;
+  if (!stbi_write_png(file.c_str(), width, height, 3, rgb.data(), width * 3))
+  {
+    std::cout << "ERROR::FRAME_CAPTURE: Failed to write " << file << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// BT.601 (studio range) luma per pixel, chroma per 2x2 block
+bool FrameCapture::writeY4m(const std::vector<unsigned char> &pixels, std::vector<unsigned char> &yuv)
+{
+  unsigned int chromaWidth = (width + 1) / 2, chromaHeight = (height + 1) / 2;
+  size_t lumaSize = static_cast<size_t>(width) * height, chromaSize = static_cast<size_t>(chromaWidth) * chromaHeight;
+  yuv.resize(lumaSize + chromaSize * 2);
+  unsigned char *luma = yuv.data(), *u = luma + lumaSize, *v = u + chromaSize;
+  for (unsigned int y = 0; y < height; ++y)
+  {
+    const unsigned char *source = &pixels[static_cast<size_t>(height - 1 - y) * width * 4];
+    for (unsigned int x = 0; x < width; ++x, source += 4)
+      luma[static_cast<size_t>(y) * width + x] = static_cast<unsigned char>(((66 * source[0] + 129 * source[1] + 25 * source[2] + 128) >> 8) + 16);
+  }
+  for (unsigned int cy = 0; cy < chromaHeight; ++cy)
+  {
+    for (unsigned int cx = 0; cx < chromaWidth; ++cx)
+    {
+      // the block's average color, clamped at odd edges
+      int r = 0, g = 0, b = 0;
+      for (unsigned int i = 0; i < 4; ++i)
+      {
+        unsigned int x = cx * 2 + (i & 1), y = cy * 2 + (i >> 1);
+        x = x < width ? x : width - 1;
+        y = y < height ? y : height - 1;
+        const unsigned char *source = &pixels[(static_cast<size_t>(height - 1 - y) * width + x) * 4];
+        r += source[0];
+        g += source[1];
+        b += source[2];
+      }
+      r /= 4;
+      g /= 4;
+      b /= 4;
+      // offset by 128 << 8 before shifting so the sums stay positive
+      size_t index = static_cast<size_t>(cy) * chromaWidth + cx;
+      u[index] = static_cast<unsigned char>((-38 * r - 74 * g + 112 * b + 128 + (128 << 8)) >> 8);
+      v[index] = static_cast<unsigned char>((112 * r - 94 * g - 18 * b + 128 + (128 << 8)) >> 8);
+    }
+  }
+  if (std::fputs("FRAME\n", stream) < 0 || std::fwrite(yuv.data(), 1, yuv.size(), stream) != yuv.size())
+  {
+    std::cout << "ERROR::FRAME_CAPTURE: Failed to write " << path << std::endl;
+    return false;
+  }
+  return true;
+}
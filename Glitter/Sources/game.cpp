@@ -1,12 +1,50 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
 #include <tuple>
 #include <string>
 
 #include "game.hpp"
+#include "hash.hpp"
 #include "resource_manager.hpp"
-
-const std::string g_project_source_dir = PROJECT_SOURCE_DIR;
-const std::string basePath = g_project_source_dir + "/Glitter";
-
+#include "startup_timeline.hpp"
+
+// Levels in play order ("Levels/solid.lvl" is a test level)
+const char *const LEVEL_FILES[] = {"Levels/one.lvl", "Levels/two.lvl", "Levels/three.lvl", "Levels/four.lvl"};
+const unsigned int LEVEL_FILE_COUNT = sizeof(LEVEL_FILES) / sizeof(LEVEL_FILES[0]);
+// Textures of the scene, by name in the ResourceManager and by index in the slots of a
+// SoftwareRenderer or SpectatorRenderer
+enum SceneTexture
+{
+  SCENE_BACKGROUND,
+  SCENE_FACE,
+  SCENE_BLOCK,
+  SCENE_BLOCK_SOLID,
+  SCENE_PADDLE,
+  SCENE_PARTICLE,
+  // one per PowerUpType
+  SCENE_POWER_UPS,
+  SCENE_TEXTURES = SCENE_POWER_UPS + POWER_UP_TYPES
+};
+struct SceneTextureFile
+{
+  const char *File;
+  bool Alpha;
+  const char *Name;
+};
+const SceneTextureFile SCENE_TEXTURE_FILES[SCENE_TEXTURES] = {
+    {"Textures/background.jpg", false, "background"},
+    {"Textures/awesomeface.png", true, "face"},
+    {"Textures/block.png", false, "block"},
+    {"Textures/block_solid.png", false, "block_solid"},
+    {"Textures/paddle.png", true, "paddle"},
+    {"Textures/particle.png", true, "particle"},
+    {"Textures/powerup_speed.png", true, "tex_speed"},
+    {"Textures/powerup_sticky.png", true, "tex_sticky"},
+    {"Textures/powerup_passthrough.png", true, "tex_pass"},
+    {"Textures/powerup_increase.png", true, "tex_increase"},
+    {"Textures/powerup_confuse.png", true, "tex_confuse"},
+    {"Textures/powerup_chaos.png", true, "tex_chaos"}};
 // Initial size of the player paddle
 const glm::vec2 PLAYER_SIZE(100.0f, 20.0f);
 // Initial velocity of the player paddle
@@ -16,98 +54,92 @@ const float BALL_RADIUS = 12.5f;
 // Initial velocity of the Ball
 const glm::vec2 INITIAL_BALL_VELOCITY(100.0f, -350.0f);
 
-float ShakeTime = 0.0f;
-
 Game::Game(unsigned int width, unsigned int height)
-    : State(GAME_ACTIVE), Width(width), Height(height)
+    : State(GAME_ACTIVE), Keys(), Width(width), Height(height), CurrentLevel(0),
+      Confuse(false), Chaos(false), Shake(false), ShakeTime(0.0f), BallsLost(0),
+      GameplayRandom(1, STREAM_GAMEPLAY), CosmeticRandom(1, STREAM_COSMETIC), UpdateParticles(true),
+      Renderer(nullptr), Player(nullptr), Ball(nullptr), Particles(nullptr), Effects(nullptr)
 {
 }
 
 Game::~Game()
 {
-  delete Renderer;
+  ReleaseRenderers();
   delete Player;
   delete Ball;
+}
+
+void Game::ReleaseRenderers()
+{
+  delete Renderer;
   delete Particles;
   delete Effects;
+  Renderer = nullptr;
+  Particles = nullptr;
+  Effects = nullptr;
 }
 
 void Game::Init()
 {
-  // Set game projection matrix
-  glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(Width),
-                                    static_cast<float>(Height), 0.0f, -1.0f, 1.0f);
+  // Start decoding textures and compiling levels right away, so worker threads do
+  // that while the shaders compile on this thread
+  for (const SceneTextureFile &texture : SCENE_TEXTURE_FILES)
+    ResourceManager::QueueTexture(texture.File, texture.Alpha, texture.Name);
+  for (const char *level : LEVEL_FILES)
+    ResourceManager::QueueLevel(level);
+  StartupTimeline::Mark("assets queued");
+
   // Load shaders
-  ResourceManager::LoadShader((basePath + "/Shaders/sprite_shader.vert").c_str(),
-                              (basePath + "/Shaders/sprite_shader.frag").c_str(),
+  ResourceManager::LoadShader("Shaders/sprite_shader.vert",
+                              "Shaders/sprite_shader.frag",
                               nullptr, "sprite");
-  ResourceManager::LoadShader((basePath + "/Shaders/particle_shader.vert").c_str(),
-                              (basePath + "/Shaders/particle_shader.frag").c_str(),
+  ResourceManager::LoadShader("Shaders/particle_shader.vert",
+                              "Shaders/particle_shader.frag",
                               nullptr, "particle");
-  ResourceManager::LoadShader((basePath + "/Shaders/post_proc_shader.vert").c_str(),
-                              (basePath + "/Shaders/post_proc_shader.frag").c_str(),
-                              nullptr, "effects");
-
-  ResourceManager::GetShader("sprite").Use();
-  ResourceManager::GetShader("sprite").SetInteger("spriteTexture", 0);
-  ResourceManager::GetShader("sprite").SetMatrix4("projection", projection);
-
-  ResourceManager::GetShader("particle").Use();
-  ResourceManager::GetShader("particle").SetInteger("sprite", 0);
-  ResourceManager::GetShader("particle").SetMatrix4("projection", projection);
+  // one post-processing program per combination of effects, specialized with #defines. The plain
+  // variant (no effects) upscales scenes rendered at a lower resolution
+  Shader effectShaders[POST_EFFECT_COMBINATIONS];
+  bool fxaa = AntiAliasingMode.Mode == AA_FXAA;
+  for (unsigned int variant = 0; variant < POST_EFFECT_COMBINATIONS; ++variant)
+    if (PostProcessor::Variant(variant) == variant && (variant == 0 || ((variant & POST_EFFECT_FXAA) != 0) == fxaa))
+      effectShaders[variant] = ResourceManager::LoadShader("Shaders/post_proc_shader.vert",
+                                                           "Shaders/post_proc_shader.frag",
+                                                           nullptr, PostProcessor::VariantName(variant),
+                                                           PostProcessor::VariantDefines(variant));
+  ConfigureShaders();
 
   Renderer = new SpriteRenderer(ResourceManager::GetShader("sprite"));
 
-  Effects = new PostProcessor(ResourceManager::GetShader("effects"), Width * 2, Height * 2);
-
-  // Load textures
-  ResourceManager::LoadTexture(
-      (basePath + "/Textures/background.jpg").c_str(), false, "background");
-  ResourceManager::LoadTexture((basePath + "/Textures/awesomeface.png").c_str(), true, "face");
-  ResourceManager::LoadTexture((basePath + "/Textures/block.png").c_str(), false, "block");
-  ResourceManager::LoadTexture(
-      (basePath + "/Textures/block_solid.png").c_str(), false, "block_solid");
-  ResourceManager::LoadTexture((basePath + "/Textures/paddle.png").c_str(), true, "paddle");
-  ResourceManager::LoadTexture((basePath + "/Textures/particle.png").c_str(), true, "particle");
-  ResourceManager::LoadTexture((basePath + "/Textures/powerup_chaos.png").c_str(), true, "tex_chaos");
-  ResourceManager::LoadTexture((basePath + "/Textures/powerup_confuse.png").c_str(), true, "tex_confuse");
-  ResourceManager::LoadTexture((basePath + "/Textures/powerup_increase.png").c_str(), true, "tex_increase");
-  ResourceManager::LoadTexture((basePath + "/Textures/powerup_passthrough.png").c_str(), true, "tex_pass");
-  ResourceManager::LoadTexture((basePath + "/Textures/powerup_speed.png").c_str(), true, "tex_speed");
-  ResourceManager::LoadTexture((basePath + "/Textures/powerup_sticky.png").c_str(), true, "tex_sticky");
-
-  // Load levels
-  GameLevel one, two, three, four, solid;
-  one.Load((basePath + "/Levels/one.lvl").c_str(), Width, Height / 2);
-  two.Load((basePath + "/Levels/two.lvl").c_str(), Width, Height / 2);
-  three.Load((basePath + "/Levels/three.lvl").c_str(), Width, Height / 2);
-  four.Load((basePath + "/Levels/four.lvl").c_str(), Width, Height / 2);
-
-  // solid.Load((basePath + "/Levels/solid.lvl").c_str(), Width, Height / 2);
-  // Levels.push_back(solid);
-
-  Levels.push_back(one);
-  Levels.push_back(two);
-  Levels.push_back(three);
-  Levels.push_back(four);
-  CurrentLevel = 0;
+  // sized to the game until the window reports its framebuffer size (SetFramebufferSize)
+  Effects = new PostProcessor(effectShaders, Width, Height, AntiAliasingMode);
 
-  // Initialize player paddle
-  glm::vec2 playerPos = glm::vec2(
-      Width / 2 - PLAYER_SIZE.x / 2, Height - PLAYER_SIZE.y);
-  Player = new GameObject(playerPos, PLAYER_SIZE, ResourceManager::GetTexture("paddle"));
+  StartupTimeline::Mark("renderers ready");
 
-  // Initialize ball object
-  glm::vec2 ballPos = playerPos + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS,
-                                            -BALL_RADIUS * 2.0f);
-  Ball = new BallObject(ballPos, BALL_RADIUS, INITIAL_BALL_VELOCITY,
-                        ResourceManager::GetTexture("face"));
+  // Generate the textures as their decodes finish
+  ResourceManager::FinishTextures();
+  StartupTimeline::Mark("textures generated");
+
+  LoadLevels();
+  StartupTimeline::Mark("levels built");
+  InitPlayer();
+  ResolveHandles();
 
   // Inititalize the Particle Generator
   Particles = new ParticleGenerator(
       ResourceManager::GetShader("particle"),
       ResourceManager::GetTexture("particle"),
-      500);
+      500, CosmeticRandom);
+}
+
+void Game::InitHeadless()
+{
+  // No shaders, textures or render targets: bricks, paddle, ball and particles all
+  // reference empty Texture2D objects and the effects are only tracked as flags
+  LoadLevels();
+  InitPlayer();
+  ResolveHandles();
+
+  Particles = new ParticleGenerator(Shader(), Texture2D(), 500, CosmeticRandom);
 }
 
 void Game::ProcessInput(float dt)
@@ -159,12 +191,14 @@ void Game::Update(float dt)
   Ball->Move(dt, Width);
   DoCollisions();
 
-  Particles->Update(dt, *Ball, 2, glm::vec2(Ball->Radius / 2.0f));
+  if (UpdateParticles)
+    Particles->Update(dt, *Ball, 2, glm::vec2(Ball->Radius / 2.0f));
 
   UpdatePowerUps(dt);
 
   if (Ball->Position.y >= Height)
   {
+    BallsLost++;
     ResetLevel();
     ResetPlayer();
   }
@@ -173,20 +207,23 @@ void Game::Update(float dt)
   {
     ShakeTime -= dt;
     if (ShakeTime <= 0.0f)
-      Effects->Shake = false;
+      Shake = false;
   }
 }
 
-void Game::Render()
+void Game::Render(float time)
 {
   // Render the game scene
   // This function should draw the game objects to the screen.;
   if (State == GAME_ACTIVE)
   {
+    Effects->Confuse = Confuse;
+    Effects->Chaos = Chaos;
+    Effects->Shake = Shake;
     Effects->BeginRender();
 
     // Draw background
-    Renderer->DrawSprite(ResourceManager::GetTexture("background"), glm::vec2(0.0f, 0.0f),
+    Renderer->DrawSprite(ResourceManager::GetTexture(BackgroundTexture), glm::vec2(0.0f, 0.0f),
                          glm::vec2(static_cast<float>(Width), static_cast<float>(Height)));
     // Draw current level
     Levels[CurrentLevel].Draw(*Renderer);
@@ -205,11 +242,72 @@ void Game::Render()
       if (!powerUp.Destroyed)
         powerUp.Draw(*Renderer);
 
-    Effects->EndRender();
-    Effects->Render(glfwGetTime());
+    Effects->EndRender(time);
   }
 }
 
+void Game::Render(SoftwareRenderer &renderer) const
+{
+  if (State != GAME_ACTIVE)
+    return;
+  // the same draws as Render, in the same order
+  renderer.Begin();
+  renderer.DrawSprite(SCENE_BACKGROUND, glm::vec2(0.0f, 0.0f),
+                      glm::vec2(static_cast<float>(Width), static_cast<float>(Height)));
+  Levels[CurrentLevel].Draw(renderer, SCENE_BLOCK, SCENE_BLOCK_SOLID);
+  renderer.DrawSprite(SCENE_PADDLE, Player->Position, Player->Size, Player->Color);
+  if (Particles)
+    Particles->Draw(renderer, SCENE_PARTICLE);
+  renderer.DrawSprite(SCENE_FACE, Ball->Position, Ball->Size, Ball->Color);
+  for (const PowerUp &powerUp : PowerUps)
+    if (!powerUp.Destroyed)
+      renderer.DrawSprite(SCENE_POWER_UPS + powerUp.Type, powerUp.Position, powerUp.Size, powerUp.Color);
+  renderer.Finish();
+}
+
+bool Game::LoadSoftwareTextures(SoftwareRenderer &renderer)
+{
+  bool loaded = true;
+  for (unsigned int texture = 0; texture < SCENE_TEXTURES; ++texture)
+    loaded = renderer.LoadTexture(texture, SCENE_TEXTURE_FILES[texture].File, SCENE_TEXTURE_FILES[texture].Alpha) && loaded;
+  return loaded;
+}
+
+void Game::Render(SpectatorRenderer &renderer, unsigned int tile, float time) const
+{
+  if (State != GAME_ACTIVE)
+    return;
+  renderer.SetEffects(tile, Confuse, Shake, time);
+  renderer.DrawSprite(tile, SCENE_BACKGROUND, glm::vec2(0.0f, 0.0f),
+                      glm::vec2(static_cast<float>(Width), static_cast<float>(Height)));
+  Levels[CurrentLevel].Draw(renderer, tile, SCENE_BLOCK, SCENE_BLOCK_SOLID);
+  renderer.DrawSprite(tile, SCENE_PADDLE, Player->Position, Player->Size, Player->Color);
+  if (Particles && renderer.Detailed())
+    Particles->Draw(renderer, tile, SCENE_PARTICLE);
+  renderer.DrawSprite(tile, SCENE_FACE, Ball->Position, Ball->Size, Ball->Color);
+  for (const PowerUp &powerUp : PowerUps)
+    if (!powerUp.Destroyed)
+      renderer.DrawSprite(tile, SCENE_POWER_UPS + powerUp.Type, powerUp.Position, powerUp.Size, powerUp.Color);
+}
+
+void Game::SetSpectatorTextures(SpectatorRenderer &renderer)
+{
+  for (unsigned int texture = 0; texture < SCENE_TEXTURES; ++texture)
+    renderer.SetTexture(texture, ResourceManager::GetTexture(SCENE_TEXTURE_FILES[texture].Name));
+}
+
+void Game::SetFramebufferSize(unsigned int width, unsigned int height)
+{
+  if (Effects)
+    Effects->Resize(width, height);
+}
+
+void Game::SetRenderScale(float scale)
+{
+  if (Effects)
+    Effects->SetRenderScale(scale);
+}
+
 void Game::DoCollisions()
 {
   // Check for collisions between the ball and the player paddle
@@ -231,17 +329,21 @@ void Game::DoCollisions()
 
   // Check for collisions with blocks in the current level
   GameLevel &currentLevel = Levels[CurrentLevel];
-  for (GameObject &block : currentLevel.Bricks)
+  const GameObject *bricks = currentLevel.Bricks().data();
+  uint8_t *destroyed = currentLevel.Destroyed.data();
+  size_t brickCount = currentLevel.Bricks().size();
+  for (size_t i = 0; i < brickCount; ++i)
   {
-    if (block.Destroyed)
+    if ((destroyed[i / 8] >> (i % 8)) & 1)
       continue; // Skip destroyed blocks
+    const GameObject &block = bricks[i];
 
     Collision blockCollision = CheckCollision(*Ball, block);
     if (std::get<0>(blockCollision))
     {
       if (!block.IsSolid)
       {
-        block.Destroyed = true; // Mark block as destroyed
+        destroyed[i / 8] |= static_cast<uint8_t>(1 << (i % 8)); // Mark block as destroyed
         SpawnPowerUps(block);
 
         if (Ball->PassThrough)
@@ -251,7 +353,7 @@ void Game::DoCollisions()
       {
         // shake screen when hitting solid bricks
         ShakeTime = 0.05f;
-        Effects->Shake = true;
+        Shake = true;
       }
 
       Direction dir = std::get<1>(blockCollision);
@@ -295,26 +397,39 @@ void Game::DoCollisions()
   }
 }
 
-void Game::SpawnPowerUps(GameObject &block)
+void Game::SpawnPowerUps(const GameObject &block)
 {
   if (ShouldSpawn(75))
-    PowerUps.push_back(
-        PowerUp("speed", glm::vec3(0.5f, 0.5f, 1.0f), 0.0f, block.Position, ResourceManager::GetTexture("tex_speed")));
+    PowerUps.push_back(CreatePowerUp(POWER_UP_SPEED, block.Position));
   if (ShouldSpawn(75))
-    PowerUps.push_back(
-        PowerUp("sticky", glm::vec3(1.0f, 0.5f, 1.0f), 20.0f, block.Position, ResourceManager::GetTexture("tex_sticky")));
+    PowerUps.push_back(CreatePowerUp(POWER_UP_STICKY, block.Position));
   if (ShouldSpawn(75))
-    PowerUps.push_back(
-        PowerUp("pass-through", glm::vec3(0.5f, 1.0f, 0.5f), 10.0f, block.Position, ResourceManager::GetTexture("tex_pass")));
+    PowerUps.push_back(CreatePowerUp(POWER_UP_PASS_THROUGH, block.Position));
   if (ShouldSpawn(75))
-    PowerUps.push_back(
-        PowerUp("pad-size-increase", glm::vec3(1.0f, 0.6f, 0.4), 0.0f, block.Position, ResourceManager::GetTexture("tex_increase")));
+    PowerUps.push_back(CreatePowerUp(POWER_UP_PAD_SIZE_INCREASE, block.Position));
   if (ShouldSpawn(15))
-    PowerUps.push_back(
-        PowerUp("confuse", glm::vec3(1.0f, 0.3f, 0.3f), 15.0f, block.Position, ResourceManager::GetTexture("tex_confuse")));
+    PowerUps.push_back(CreatePowerUp(POWER_UP_CONFUSE, block.Position));
   if (ShouldSpawn(15))
-    PowerUps.push_back(
-        PowerUp("chaos", glm::vec3(0.9f, 0.25f, 0.25f), 15.0f, block.Position, ResourceManager::GetTexture("tex_chaos")));
+    PowerUps.push_back(CreatePowerUp(POWER_UP_CHAOS, block.Position));
+}
+
+PowerUp Game::CreatePowerUp(PowerUpType type, glm::vec2 position) const
+{
+  switch (type)
+  {
+  case POWER_UP_SPEED:
+    return PowerUp(type, glm::vec3(0.5f, 0.5f, 1.0f), 0.0f, position, ResourceManager::GetTexture(SpeedTexture));
+  case POWER_UP_STICKY:
+    return PowerUp(type, glm::vec3(1.0f, 0.5f, 1.0f), 20.0f, position, ResourceManager::GetTexture(StickyTexture));
+  case POWER_UP_PASS_THROUGH:
+    return PowerUp(type, glm::vec3(0.5f, 1.0f, 0.5f), 10.0f, position, ResourceManager::GetTexture(PassThroughTexture));
+  case POWER_UP_PAD_SIZE_INCREASE:
+    return PowerUp(type, glm::vec3(1.0f, 0.6f, 0.4), 0.0f, position, ResourceManager::GetTexture(IncreaseTexture));
+  case POWER_UP_CONFUSE:
+    return PowerUp(type, glm::vec3(1.0f, 0.3f, 0.3f), 15.0f, position, ResourceManager::GetTexture(ConfuseTexture));
+  default:
+    return PowerUp(type, glm::vec3(0.9f, 0.25f, 0.25f), 15.0f, position, ResourceManager::GetTexture(ChaosTexture));
+  }
 }
 
 void Game::UpdatePowerUps(float dt)
@@ -331,34 +446,34 @@ void Game::UpdatePowerUps(float dt)
         // remove powerup from list (will later be removed)
         powerUp.Activated = false;
         // deactivate effects
-        if (powerUp.Type == "sticky")
+        if (powerUp.Type == POWER_UP_STICKY)
         {
-          if (!IsOtherPowerUpActive(PowerUps, "sticky"))
+          if (!IsOtherPowerUpActive(PowerUps, POWER_UP_STICKY))
           { // only reset if no other PowerUp of type sticky is active
             Ball->Sticky = false;
             Player->Color = glm::vec3(1.0f);
           }
         }
-        else if (powerUp.Type == "pass-through")
+        else if (powerUp.Type == POWER_UP_PASS_THROUGH)
         {
-          if (!IsOtherPowerUpActive(PowerUps, "pass-through"))
+          if (!IsOtherPowerUpActive(PowerUps, POWER_UP_PASS_THROUGH))
           { // only reset if no other PowerUp of type pass-through is active
             Ball->PassThrough = false;
             Ball->Color = glm::vec3(1.0f);
           }
         }
-        else if (powerUp.Type == "confuse")
+        else if (powerUp.Type == POWER_UP_CONFUSE)
         {
-          if (!IsOtherPowerUpActive(PowerUps, "confuse"))
+          if (!IsOtherPowerUpActive(PowerUps, POWER_UP_CONFUSE))
           { // only reset if no other PowerUp of type confuse is active
-            Effects->Confuse = false;
+            Confuse = false;
           }
         }
-        else if (powerUp.Type == "chaos")
+        else if (powerUp.Type == POWER_UP_CHAOS)
         {
-          if (!IsOtherPowerUpActive(PowerUps, "chaos"))
+          if (!IsOtherPowerUpActive(PowerUps, POWER_UP_CHAOS))
           { // only reset if no other PowerUp of type chaos is active
-            Effects->Chaos = false;
+            Chaos = false;
           }
         }
       }
@@ -370,10 +485,226 @@ void Game::UpdatePowerUps(float dt)
                  PowerUps.end());
 }
 
+void Game::SetSeed(unsigned int seed)
+{
+  GameplayRandom.Seed(seed, STREAM_GAMEPLAY);
+  CosmeticRandom.Seed(seed, STREAM_COSMETIC);
+}
+
+unsigned long long Game::StateHash() const
+{
+  unsigned long long hash = HASH_OFFSET_BASIS;
+  HashBytes(hash, &State, sizeof(State));
+  HashBytes(hash, &CurrentLevel, sizeof(CurrentLevel));
+  // one byte per brick, as when bricks held their own flag
+  const GameLevel &level = Levels[CurrentLevel];
+  for (size_t i = 0; i < level.Bricks().size(); ++i)
+  {
+    bool destroyed = level.IsDestroyed(i);
+    HashBytes(hash, &destroyed, sizeof(destroyed));
+  }
+
+  HashBytes(hash, &Player->Position, sizeof(Player->Position));
+  HashBytes(hash, &Player->Size, sizeof(Player->Size));
+  HashBytes(hash, &Ball->Position, sizeof(Ball->Position));
+  HashBytes(hash, &Ball->Velocity, sizeof(Ball->Velocity));
+  bool ballFlags[3] = {Ball->Stuck, Ball->Sticky, Ball->PassThrough};
+  HashBytes(hash, ballFlags, sizeof(ballFlags));
+
+  for (const PowerUp &powerUp : PowerUps)
+  {
+    // by name, so hashes stay comparable with recordings made when types were strings
+    const char *type = PowerUpName(powerUp.Type);
+    HashBytes(hash, type, std::strlen(type));
+    HashBytes(hash, &powerUp.Position, sizeof(powerUp.Position));
+    HashBytes(hash, &powerUp.Duration, sizeof(powerUp.Duration));
+    bool powerUpFlags[2] = {powerUp.Activated, powerUp.Destroyed};
+    HashBytes(hash, powerUpFlags, sizeof(powerUpFlags));
+  }
+
+  bool effects[3] = {Confuse, Chaos, Shake};
+  HashBytes(hash, effects, sizeof(effects));
+  HashBytes(hash, &ShakeTime, sizeof(ShakeTime));
+  HashBytes(hash, GameplayRandom.State, sizeof(GameplayRandom.State));
+  return hash;
+}
+
+bool Game::FitsSnapshot() const
+{
+  return Levels[CurrentLevel].Bricks().size() <= SNAPSHOT_MAX_BRICKS && PowerUps.size() <= SNAPSHOT_MAX_POWER_UPS;
+}
+
+bool Game::SaveSnapshot(GameSnapshot &snapshot) const
+{
+  const GameLevel &level = Levels[CurrentLevel];
+  const std::vector<GameObject> &bricks = level.Bricks();
+  if (!FitsSnapshot())
+  {
+    std::cout << "ERROR::GAME: Snapshot can't hold " << bricks.size() << " bricks and "
+              << PowerUps.size() << " power-ups" << std::endl;
+    return false;
+  }
+  snapshot.State = State;
+  snapshot.CurrentLevel = CurrentLevel;
+  snapshot.PlayerPosition = Player->Position;
+  snapshot.PlayerSize = Player->Size;
+  snapshot.PlayerColor = Player->Color;
+  snapshot.BallPosition = Ball->Position;
+  snapshot.BallVelocity = Ball->Velocity;
+  snapshot.BallColor = Ball->Color;
+  snapshot.BallStuck = Ball->Stuck;
+  snapshot.BallSticky = Ball->Sticky;
+  snapshot.BallPassThrough = Ball->PassThrough;
+  snapshot.Confuse = Confuse;
+  snapshot.Chaos = Chaos;
+  snapshot.Shake = Shake;
+  snapshot.ShakeTime = ShakeTime;
+  snapshot.GameplayRandom = GameplayRandom;
+
+  snapshot.BrickCount = static_cast<uint32_t>(bricks.size());
+  std::memcpy(snapshot.DestroyedBricks, level.Destroyed.data(), level.Destroyed.size());
+
+  snapshot.PowerUpCount = static_cast<uint32_t>(PowerUps.size());
+  for (size_t i = 0; i < PowerUps.size(); ++i)
+  {
+    PowerUpSnapshot &powerUp = snapshot.PowerUps[i];
+    powerUp.Position = PowerUps[i].Position;
+    powerUp.Duration = PowerUps[i].Duration;
+    powerUp.Type = static_cast<uint8_t>(PowerUps[i].Type);
+    powerUp.Activated = PowerUps[i].Activated;
+    powerUp.Destroyed = PowerUps[i].Destroyed;
+  }
+  return true;
+}
+
+bool Game::RestoreSnapshot(const GameSnapshot &snapshot)
+{
+  if (snapshot.CurrentLevel >= Levels.size() || snapshot.BrickCount != Levels[snapshot.CurrentLevel].Bricks().size() ||
+      snapshot.PowerUpCount > SNAPSHOT_MAX_POWER_UPS)
+  {
+    std::cout << "ERROR::GAME: Snapshot doesn't match the loaded levels" << std::endl;
+    return false;
+  }
+  // snapshots can come from outside (e.g. bsim_restore), so every enum is checked before use
+  bool valid = snapshot.State <= GAME_WIN;
+  for (uint32_t i = 0; i < snapshot.PowerUpCount; ++i)
+    valid = valid && snapshot.PowerUps[i].Type < POWER_UP_TYPES;
+  if (!valid)
+  {
+    std::cout << "ERROR::GAME: Snapshot has an unknown game state or power-up type" << std::endl;
+    return false;
+  }
+  State = static_cast<GameState>(snapshot.State);
+  CurrentLevel = snapshot.CurrentLevel;
+  Player->Position = snapshot.PlayerPosition;
+  Player->Size = snapshot.PlayerSize;
+  Player->Color = snapshot.PlayerColor;
+  Ball->Position = snapshot.BallPosition;
+  Ball->Velocity = snapshot.BallVelocity;
+  Ball->Color = snapshot.BallColor;
+  Ball->Stuck = snapshot.BallStuck != 0;
+  Ball->Sticky = snapshot.BallSticky != 0;
+  Ball->PassThrough = snapshot.BallPassThrough != 0;
+  Confuse = snapshot.Confuse != 0;
+  Chaos = snapshot.Chaos != 0;
+  Shake = snapshot.Shake != 0;
+  ShakeTime = snapshot.ShakeTime;
+  GameplayRandom = snapshot.GameplayRandom;
+
+  GameLevel &level = Levels[CurrentLevel];
+  std::memcpy(level.Destroyed.data(), snapshot.DestroyedBricks, level.Destroyed.size());
+
+  // power-ups keep their color and texture by type, so only the moving parts were saved
+  PowerUps.clear();
+  for (uint32_t i = 0; i < snapshot.PowerUpCount; ++i)
+  {
+    const PowerUpSnapshot &saved = snapshot.PowerUps[i];
+    PowerUps.push_back(CreatePowerUp(static_cast<PowerUpType>(saved.Type), saved.Position));
+    PowerUp &powerUp = PowerUps.back();
+    powerUp.Duration = saved.Duration;
+    powerUp.Activated = saved.Activated != 0;
+    powerUp.Destroyed = saved.Destroyed != 0;
+  }
+  return true;
+}
+
 /*
  * Private helper functions
  */
 
+void Game::ReloadAssets(const std::vector<std::string> &files)
+{
+  std::vector<std::string> reloadedShaders;
+  for (const std::string &file : files)
+  {
+    bool used = ResourceManager::ReloadAsset(file, reloadedShaders);
+    // a level gets a new template, which also restores its destroyed bricks (levels added
+    // after the shipped ones, e.g. by bsim_load_level, have no file to reload from)
+    for (unsigned int i = 0; i < LEVEL_FILE_COUNT && i < Levels.size(); ++i)
+    {
+      if (file != LEVEL_FILES[i])
+        continue;
+      Levels[i] = GameLevel(ResourceManager::LoadLevel(LEVEL_FILES[i], Width, Height / 2));
+      used = true;
+    }
+    if (used)
+      std::cout << "Reloaded " << file << std::endl;
+  }
+  // relinking resets a program's uniforms
+  if (!reloadedShaders.empty())
+  {
+    ConfigureShaders();
+    Effects->ConfigureShaders();
+  }
+}
+
+void Game::ConfigureShaders()
+{
+  // Set game projection matrix
+  glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(Width),
+                                    static_cast<float>(Height), 0.0f, -1.0f, 1.0f);
+
+  ResourceManager::GetShader("sprite").Use();
+  ResourceManager::GetShader("sprite").SetInteger("spriteTexture", 0);
+  ResourceManager::GetShader("sprite").SetMatrix4("projection", projection);
+
+  ResourceManager::GetShader("particle").Use();
+  ResourceManager::GetShader("particle").SetInteger("sprite", 0);
+  ResourceManager::GetShader("particle").SetMatrix4("projection", projection);
+}
+
+void Game::LoadLevels()
+{
+  for (const char *level : LEVEL_FILES)
+    Levels.push_back(GameLevel(ResourceManager::LoadLevel(level, Width, Height / 2)));
+  CurrentLevel = 0;
+}
+
+void Game::InitPlayer()
+{
+  // Initialize player paddle
+  glm::vec2 playerPos = glm::vec2(
+      Width / 2 - PLAYER_SIZE.x / 2, Height - PLAYER_SIZE.y);
+  Player = new GameObject(playerPos, PLAYER_SIZE, ResourceManager::GetTexture("paddle"));
+
+  // Initialize ball object
+  glm::vec2 ballPos = playerPos + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS,
+                                            -BALL_RADIUS * 2.0f);
+  Ball = new BallObject(ballPos, BALL_RADIUS, INITIAL_BALL_VELOCITY,
+                        ResourceManager::GetTexture("face"));
+}
+
+void Game::ResolveHandles()
+{
+  BackgroundTexture = ResourceManager::GetTextureHandle(HashName("background"));
+  SpeedTexture = ResourceManager::GetTextureHandle(HashName("tex_speed"));
+  StickyTexture = ResourceManager::GetTextureHandle(HashName("tex_sticky"));
+  PassThroughTexture = ResourceManager::GetTextureHandle(HashName("tex_pass"));
+  IncreaseTexture = ResourceManager::GetTextureHandle(HashName("tex_increase"));
+  ConfuseTexture = ResourceManager::GetTextureHandle(HashName("tex_confuse"));
+  ChaosTexture = ResourceManager::GetTextureHandle(HashName("tex_chaos"));
+}
+
 void Game::ResetLevel()
 {
   // Could also just reload all the levels...
@@ -385,10 +716,7 @@ void Game::ResetLevel()
   //       Levels[2].Load("levels/three.lvl", Width, Height / 2);
   //   else if (CurrentLevel == 3)
   //       Levels[3].Load("levels/four.lvl", Width, Height / 2);
-  for (GameObject &brick : Levels[CurrentLevel].Bricks)
-  {
-    brick.Destroyed = false;
-  }
+  Levels[CurrentLevel].Reset();
 }
 
 void Game::ResetPlayer()
@@ -425,7 +753,7 @@ Direction Game::VectorDirection(glm::vec2 target)
   return static_cast<Direction>(bestMatch);
 }
 
-bool Game::CheckCollision(GameObject &one, GameObject &two)
+bool Game::CheckCollision(const GameObject &one, const GameObject &two)
 {
   // Check for collision between two game objects
   // This function should return true if the two game objects are colliding.
@@ -436,7 +764,7 @@ bool Game::CheckCollision(GameObject &one, GameObject &two)
   return collisionX && collisionY;
 }
 
-Collision Game::CheckCollision(BallObject &one, GameObject &two)
+Collision Game::CheckCollision(const BallObject &one, const GameObject &two)
 {
   // Check for collision between a ball object and a game object
   // This function should return true if the two game objects are colliding.
@@ -461,11 +789,10 @@ Collision Game::CheckCollision(BallObject &one, GameObject &two)
 
 bool Game::ShouldSpawn(unsigned int chance)
 {
-  unsigned int random = rand() % chance;
-  return random == 0;
+  return GameplayRandom.NextBelow(chance) == 0;
 }
 
-bool Game::IsOtherPowerUpActive(std::vector<PowerUp> &powerUps, std::string type)
+bool Game::IsOtherPowerUpActive(std::vector<PowerUp> &powerUps, PowerUpType type)
 {
   for (const PowerUp &powerUp : powerUps)
   {
@@ -479,33 +806,33 @@ bool Game::IsOtherPowerUpActive(std::vector<PowerUp> &powerUps, std::string type
 void Game::ActivatePowerUp(PowerUp &powerUp)
 {
   // Positive PowerUps
-  if (powerUp.Type == "speed")
+  if (powerUp.Type == POWER_UP_SPEED)
   {
     Ball->Velocity *= 1.2;
   }
-  else if (powerUp.Type == "sticky")
+  else if (powerUp.Type == POWER_UP_STICKY)
   {
     Ball->Sticky = true;
     Player->Color = glm::vec3(1.0f, 0.5f, 1.0f);
   }
-  else if (powerUp.Type == "pass-through")
+  else if (powerUp.Type == POWER_UP_PASS_THROUGH)
   {
     Ball->PassThrough = true;
     Ball->Color = glm::vec3(1.0f, 0.5f, 0.5f);
   }
-  else if (powerUp.Type == "pad-size-increase")
+  else if (powerUp.Type == POWER_UP_PAD_SIZE_INCREASE)
   {
     Player->Size.x += 50;
   }
   // Negative Powerups
-  else if (powerUp.Type == "confuse")
+  else if (powerUp.Type == POWER_UP_CONFUSE)
   {
-    if (!Effects->Confuse)
-      Effects->Confuse = true;
+    if (!Confuse)
+      Confuse = true;
   }
-  else if (powerUp.Type == "chaos")
+  else if (powerUp.Type == POWER_UP_CHAOS)
   {
-    if (!Effects->Chaos)
-      Effects->Chaos = true;
+    if (!Chaos)
+      Chaos = true;
   }
 }
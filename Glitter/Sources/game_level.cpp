@@ -1,114 +1,160 @@
-#include <fstream>
+#include <algorithm>
+#include <cstring>
 #include <iostream>
-#include <sstream>
 
 #include "game_level.hpp"
+#include "mapped_file.hpp"
 #include "resource_manager.hpp"
 
-void GameLevel::Load(const char *file, unsigned int levelWidth, unsigned int levelHeight)
+void LevelTemplate::Load(const char *file, unsigned int levelWidth, unsigned int levelHeight)
+{
+  // Map the level file, compiled levels are used in place
+  MappedFile mapped;
+  if (!mapped.Open(file))
+  {
+    this->Bricks.clear();
+    this->Breakable.clear();
+    std::cerr << "ERROR::GAME_LEVEL::LOAD::Failed to read level file: " << file << std::endl;
+    return;
+  }
+  this->Load(mapped.Data(), mapped.Size(), levelWidth, levelHeight);
+}
+
+void LevelTemplate::Load(const unsigned char *data, size_t size, unsigned int levelWidth, unsigned int levelHeight)
 {
   // Clear any existing bricks
   this->Bricks.clear();
-  // Load level data from file and initialize the level
-  unsigned int tileCode;
-  GameLevel level;
-  std::string line;
-  std::ifstream fstream(file);
-  std::vector<std::vector<unsigned int>> tileData;
-
-  if (fstream)
+  this->Breakable.clear();
+  if (size >= sizeof(LEVEL_FILE_MAGIC) &&
+      std::memcmp(data, LEVEL_FILE_MAGIC, sizeof(LEVEL_FILE_MAGIC)) == 0)
   {
-    // Read the file line by line
-    while (std::getline(fstream, line))
+    const LevelFileHeader *header = ReadCompiledLevel(data, size);
+    if (!header)
     {
-      std::istringstream sstream(line);
-      std::vector<unsigned int> row;
-      // Read each tile code in the line
-      while (sstream >> tileCode)
-      {
-        row.push_back(tileCode);
-      }
-      tileData.push_back(row);
+      std::cerr << "ERROR::GAME_LEVEL::LOAD::Invalid compiled level" << std::endl;
+      return;
     }
+    this->Bricks.reserve(header->BrickCount);
+    this->init(data + header->TilesOffset, header->Width, header->Height,
+               reinterpret_cast<const LevelTileInfo *>(data + header->TableOffset),
+               levelWidth, levelHeight);
+    return;
+  }
+
+  // otherwise it's a text level, parse it into tile codes first
+  LevelTiles tiles;
+  if (ParseLevelText(reinterpret_cast<const char *>(data), size, tiles))
+    this->init(tiles.Codes.data(), tiles.Width, tiles.Height, DefaultTileTable(),
+               levelWidth, levelHeight);
+}
 
-    // initialize the level with the tile data
-    if (!tileData.empty())
+void LevelTemplate::init(const unsigned char *tiles, unsigned int width, unsigned int height,
+                     const LevelTileInfo *tileTable, unsigned int levelWidth, unsigned int levelHeight)
+{
+  // calculate dimensions
+  float unit_width = levelWidth / static_cast<float>(width);
+  float unit_height = levelHeight / static_cast<float>(height);
+  glm::vec2 size(unit_width, unit_height);
+  Texture2D solidTexture = ResourceManager::GetTexture("block_solid");
+  Texture2D blockTexture = ResourceManager::GetTexture("block");
+
+  // initialize level tiles based on tile data
+  for (unsigned int y = 0; y < height; ++y)
+  {
+    for (unsigned int x = 0; x < width; ++x)
     {
-      this->init(tileData, levelWidth, levelHeight);
+      unsigned char code = tiles[y * width + x];
+      if (code > 0) // is a valid tile
+      {
+        const LevelTileInfo &info = tileTable[code];
+        glm::vec2 pos(x * unit_width, y * unit_height);
+        glm::vec3 color(info.Color[0], info.Color[1], info.Color[2]);
+        GameObject brick(pos, size, info.Solid ? solidTexture : blockTexture, color);
+        brick.IsSolid = info.Solid != 0;
+        this->Bricks.push_back(brick);
+      }
     }
   }
-  else
+
+  this->Breakable.assign((this->Bricks.size() + 7) / 8, 0);
+  for (size_t i = 0; i < this->Bricks.size(); ++i)
   {
-    std::cerr << "ERROR::GAME_LEVEL::LOAD::Failed to read level file: " << file << std::endl;
-    return;
+    if (!this->Bricks[i].IsSolid)
+      this->Breakable[i / 8] |= static_cast<uint8_t>(1 << (i % 8));
   }
 }
 
-void GameLevel::Draw(SpriteRenderer &renderer)
+GameLevel::GameLevel()
+    : Template(std::make_shared<LevelTemplate>())
+{
+}
+
+GameLevel::GameLevel(std::shared_ptr<const LevelTemplate> levelTemplate)
+    : Template(levelTemplate), Destroyed((levelTemplate->Bricks.size() + 7) / 8, 0)
+{
+}
+
+void GameLevel::Load(const char *file, unsigned int levelWidth, unsigned int levelHeight)
+{
+  std::shared_ptr<LevelTemplate> loaded = std::make_shared<LevelTemplate>();
+  loaded->Load(file, levelWidth, levelHeight);
+  *this = GameLevel(loaded);
+}
+
+void GameLevel::Load(const unsigned char *data, size_t size, unsigned int levelWidth, unsigned int levelHeight)
+{
+  std::shared_ptr<LevelTemplate> loaded = std::make_shared<LevelTemplate>();
+  loaded->Load(data, size, levelWidth, levelHeight);
+  *this = GameLevel(loaded);
+}
+
+void GameLevel::Reset()
+{
+  std::fill(this->Destroyed.begin(), this->Destroyed.end(), 0);
+}
+
+void GameLevel::Draw(SpriteRenderer &renderer) const
 {
   // iterate through all bricks and draw them
-  for (GameObject &brick : this->Bricks)
+  const std::vector<GameObject> &bricks = this->Bricks();
+  for (size_t i = 0; i < bricks.size(); ++i)
   {
-    if (!brick.Destroyed) // only draw non-destroyed bricks
-      brick.Draw(renderer);
+    if (!this->IsDestroyed(i)) // only draw non-destroyed bricks
+      renderer.DrawSprite(bricks[i].Sprite, bricks[i].Position, bricks[i].Size, bricks[i].Rotation, bricks[i].Color);
   }
 }
 
-bool GameLevel::IsCompleted()
+void GameLevel::Draw(SoftwareRenderer &renderer, unsigned int blockTexture, unsigned int solidTexture) const
 {
-  // check if all non-solid bricks are destroyed
-  for (GameObject &brick : this->Bricks)
+  const std::vector<GameObject> &bricks = this->Bricks();
+  for (size_t i = 0; i < bricks.size(); ++i)
   {
-    if (!brick.IsSolid && !brick.Destroyed)
-      return false; // found a non-solid brick that is not destroyed
+    if (!this->IsDestroyed(i))
+      renderer.DrawSprite(bricks[i].IsSolid ? solidTexture : blockTexture, bricks[i].Position, bricks[i].Size,
+                          bricks[i].Color);
   }
-  return true; // all non-solid bricks are destroyed
 }
 
-void GameLevel::init(std::vector<std::vector<unsigned int>> tileData,
-                     unsigned int levelWidth, unsigned int levelHeight)
+void GameLevel::Draw(SpectatorRenderer &renderer, unsigned int tile, unsigned int blockTexture,
+                     unsigned int solidTexture) const
 {
-  // calculate dimensions
-  unsigned int height = tileData.size();
-  unsigned int width = tileData[0].size();
-  float unit_width = levelWidth / static_cast<float>(width);
-  float unit_height = levelHeight / static_cast<float>(height);
+  const std::vector<GameObject> &bricks = this->Bricks();
+  for (size_t i = 0; i < bricks.size(); ++i)
+  {
+    if (!this->IsDestroyed(i))
+      renderer.DrawSprite(tile, bricks[i].IsSolid ? solidTexture : blockTexture, bricks[i].Position, bricks[i].Size,
+                          bricks[i].Color);
+  }
+}
 
-  // initialize level tiles based on tile data
-  for (unsigned int y = 0; y < height; ++y)
+bool GameLevel::IsCompleted() const
+{
+  // check if all non-solid bricks are destroyed, eight at a time
+  const std::vector<uint8_t> &breakable = this->Template->Breakable;
+  for (size_t i = 0; i < breakable.size(); ++i)
   {
-    for (unsigned int x = 0; x < width; ++x)
-    {
-      if (tileData[y][x] > 0) // is a valid tile
-      {
-        glm::vec2 pos(x * unit_width, y * unit_height);
-        glm::vec2 size(unit_width, unit_height);
-
-        if (tileData[y][x] == 1) // solid tile
-        {
-          glm::vec3 color(0.8f, 0.8f, 0.7f); // default color
-          Texture2D texture = ResourceManager::GetTexture("block_solid");
-          GameObject brick(pos, size, texture, color);
-          brick.IsSolid = true;
-          this->Bricks.push_back(brick);
-        }
-        else if (tileData[y][x] > 1) // non-solid tile
-        {
-          glm::vec3 color(1.0f);   // default white color
-          if (tileData[y][x] == 2) // green tile
-            color = glm::vec3(0.2f, 0.8f, 0.2f);
-          else if (tileData[y][x] == 3) // blue tile
-            color = glm::vec3(0.2f, 0.2f, 0.8f);
-          else if (tileData[y][x] == 4) // yellow tile
-            color = glm::vec3(0.8f, 0.8f, 0.2f);
-          else if (tileData[y][x] == 5) // red tile
-            color = glm::vec3(0.8f, 0.2f, 0.2f);
-
-          Texture2D texture = ResourceManager::GetTexture("block");
-          GameObject brick(pos, size, texture, color);
-          this->Bricks.push_back(brick);
-        }
-      }
-    }
+    if ((breakable[i] & ~this->Destroyed[i]) != 0)
+      return false; // found a non-solid brick that is not destroyed
   }
-}
\ No newline at end of file
+  return true; // all non-solid bricks are destroyed
+}
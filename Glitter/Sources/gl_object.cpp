@@ -0,0 +1,179 @@
+#include <iomanip>
+#include <iostream>
+
+#include <glad/glad.h>
+
+#include "gl_object.hpp"
+
+// Instantiate static variables
+std::map<std::string, GLObjectStats::Usage> GLObjectStats::subsystems;
+
+static unsigned int generate(GLObjectType type)
+{
+  unsigned int id = 0;
+  switch (type)
+  {
+  case GL_OBJECT_TEXTURE:
+    glGenTextures(1, &id);
+    break;
+  case GL_OBJECT_BUFFER:
+    glGenBuffers(1, &id);
+    break;
+  case GL_OBJECT_VERTEX_ARRAY:
+    glGenVertexArrays(1, &id);
+    break;
+  case GL_OBJECT_FRAMEBUFFER:
+    glGenFramebuffers(1, &id);
+    break;
+  case GL_OBJECT_RENDERBUFFER:
+    glGenRenderbuffers(1, &id);
+    break;
+  case GL_OBJECT_PROGRAM:
+    id = glCreateProgram();
+    break;
+  case GL_OBJECT_QUERY:
+    glGenQueries(1, &id);
+    break;
+  default:
+    break;
+  }
+  return id;
+}
+
+static void destroy(GLObjectType type, unsigned int id)
+{
+  switch (type)
+  {
+  case GL_OBJECT_TEXTURE:
+    glDeleteTextures(1, &id);
+    break;
+  case GL_OBJECT_BUFFER:
+    glDeleteBuffers(1, &id);
+    break;
+  case GL_OBJECT_VERTEX_ARRAY:
+    glDeleteVertexArrays(1, &id);
+    break;
+  case GL_OBJECT_FRAMEBUFFER:
+    glDeleteFramebuffers(1, &id);
+    break;
+  case GL_OBJECT_RENDERBUFFER:
+    glDeleteRenderbuffers(1, &id);
+    break;
+  case GL_OBJECT_PROGRAM:
+    glDeleteProgram(id);
+    break;
+  case GL_OBJECT_QUERY:
+    glDeleteQueries(1, &id);
+    break;
+  default:
+    break;
+  }
+}
+
+GLObject::GLObject()
+    : type(GL_OBJECT_TEXTURE), id(0), subsystem(nullptr), bytes(0)
+{
+}
+
+GLObject::GLObject(GLObjectType type, const char *subsystem)
+    : GLObject(type, generate(type), subsystem)
+{
+}
+
+GLObject::GLObject(GLObjectType type, unsigned int id, const char *subsystem)
+    : type(type), id(id), subsystem(subsystem), bytes(0)
+{
+  if (this->id)
+    GLObjectStats::subsystems[subsystem].Count[type]++;
+}
+
+GLObject::~GLObject()
+{
+  Reset();
+}
+
+GLObject::GLObject(GLObject &&other)
+    : type(other.type), id(other.id), subsystem(other.subsystem), bytes(other.bytes)
+{
+  other.id = 0;
+  other.bytes = 0;
+}
+
+GLObject &GLObject::operator=(GLObject &&other)
+{
+  if (this != &other)
+  {
+    Reset();
+    type = other.type;
+    id = other.id;
+    subsystem = other.subsystem;
+    bytes = other.bytes;
+    other.id = 0;
+    other.bytes = 0;
+  }
+  return *this;
+}
+
+void GLObject::SetBytes(size_t bytes)
+{
+  if (!id)
+    return;
+  GLObjectStats::Usage &usage = GLObjectStats::subsystems[subsystem];
+  usage.Bytes = usage.Bytes - this->bytes + bytes;
+  this->bytes = bytes;
+}
+
+void GLObject::Reset()
+{
+  if (!id)
+    return;
+  destroy(type, id);
+  GLObjectStats::Usage &usage = GLObjectStats::subsystems[subsystem];
+  usage.Count[type]--;
+  usage.Bytes -= bytes;
+  id = 0;
+  bytes = 0;
+}
+
+unsigned int GLObjectStats::Usage::Objects() const
+{
+  unsigned int objects = 0;
+  for (unsigned int type = 0; type < GL_OBJECT_TYPES; ++type)
+    objects += Count[type];
+  return objects;
+}
+
+GLObjectStats::Usage GLObjectStats::Total()
+{
+  Usage total;
+  for (const std::pair<const std::string, Usage> &subsystem : subsystems)
+  {
+    for (unsigned int type = 0; type < GL_OBJECT_TYPES; ++type)
+      total.Count[type] += subsystem.second.Count[type];
+    total.Bytes += subsystem.second.Bytes;
+  }
+  return total;
+}
+
+// one row of the usage table, the columns line up with the header printed by Print
+static void printUsage(const std::string &name, const GLObjectStats::Usage &usage)
+{
+  static const int widths[GL_OBJECT_TYPES] = {9, 8, 5, 5, 5, 9, 8};
+  std::cout << "  " << std::left << std::setw(12) << name << std::right;
+  for (unsigned int type = 0; type < GL_OBJECT_TYPES; ++type)
+    std::cout << std::setw(widths[type]) << usage.Count[type];
+  std::cout << std::fixed << std::setprecision(1) << std::setw(12) << usage.Bytes / 1024.0 << std::endl;
+}
+
+void GLObjectStats::Print()
+{
+  std::ios::fmtflags flags = std::cout.flags();
+  std::streamsize precision = std::cout.precision();
+  std::cout << "gl objects:    textures buffers vaos fbos rbos programs queries    vram KiB" << std::endl;
+  for (const std::pair<const std::string, Usage> &subsystem : subsystems)
+    if (subsystem.second.Objects() > 0)
+      printUsage(subsystem.first, subsystem.second);
+  printUsage("total", Total());
+  std::cout.flags(flags);
+  std::cout.precision(precision);
+}
@@ -0,0 +1,129 @@
+#include "headless_context.hpp"
+
+#include <iostream>
+
+#ifdef GLITTER_HAS_EGL
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+HeadlessContext::HeadlessContext()
+    : display(nullptr), context(nullptr), surface(nullptr)
+{
+}
+
+HeadlessContext::~HeadlessContext()
+{
+  Destroy();
+}
+
+#ifdef GLITTER_HAS_EGL
+
+bool HeadlessContext::Create(unsigned int width, unsigned int height, unsigned int samples)
+{
+  // prefer the surfaceless platform, it needs neither X11/Wayland nor a DRM device
+  EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+  PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+      (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+  if (getPlatformDisplay)
+    eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+  if (eglDisplay == EGL_NO_DISPLAY)
+    eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+  EGLint major, minor;
+  if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor))
+  {
+    std::cout << "ERROR::HEADLESS_CONTEXT: Failed to initialize EGL display" << std::endl;
+    return false;
+  }
+
+  // multisampled like the game's window, single sampled if that's not available
+  EGLint configAttribs[] = {
+      EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+      EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+      EGL_RED_SIZE, 8,
+      EGL_GREEN_SIZE, 8,
+      EGL_BLUE_SIZE, 8,
+      EGL_ALPHA_SIZE, 8,
+      EGL_SAMPLE_BUFFERS, samples > 1 ? 1 : 0,
+      EGL_SAMPLES, samples > 1 ? static_cast<EGLint>(samples) : 0,
+      EGL_NONE};
+  EGLConfig config;
+  EGLint numConfigs = 0;
+  if (!eglChooseConfig(eglDisplay, configAttribs, &config, 1, &numConfigs) || numConfigs == 0)
+  {
+    configAttribs[12] = EGL_NONE;
+    eglChooseConfig(eglDisplay, configAttribs, &config, 1, &numConfigs);
+  }
+  if (numConfigs == 0)
+  {
+    std::cout << "ERROR::HEADLESS_CONTEXT: No pbuffer capable EGL config" << std::endl;
+    eglTerminate(eglDisplay);
+    return false;
+  }
+
+  eglBindAPI(EGL_OPENGL_API);
+  const EGLint contextAttribs[] = {
+      EGL_CONTEXT_MAJOR_VERSION, 3,
+      EGL_CONTEXT_MINOR_VERSION, 3,
+      EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+      EGL_NONE};
+  EGLContext eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttribs);
+
+  const EGLint surfaceAttribs[] = {
+      EGL_WIDTH, static_cast<EGLint>(width),
+      EGL_HEIGHT, static_cast<EGLint>(height),
+      EGL_NONE};
+  EGLSurface eglSurface = eglCreatePbufferSurface(eglDisplay, config, surfaceAttribs);
+
+  display = eglDisplay;
+  context = eglContext;
+  surface = eglSurface;
+  if (eglContext == EGL_NO_CONTEXT || eglSurface == EGL_NO_SURFACE ||
+      !eglMakeCurrent(eglDisplay, eglSurface, eglSurface, eglContext))
+  {
+    std::cout << "ERROR::HEADLESS_CONTEXT: Failed to create GL 3.3 core context (EGL error 0x"
+              << std::hex << eglGetError() << std::dec << ")" << std::endl;
+    Destroy();
+    return false;
+  }
+  return true;
+}
+
+void HeadlessContext::Destroy()
+{
+  if (!display)
+    return;
+  eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  if (surface != EGL_NO_SURFACE)
+    eglDestroySurface(display, surface);
+  if (context != EGL_NO_CONTEXT)
+    eglDestroyContext(display, context);
+  eglTerminate(display);
+  display = context = surface = nullptr;
+}
+
+void *HeadlessContext::GetProcAddress(const char *name)
+{
+  return reinterpret_cast<void *>(eglGetProcAddress(name));
+}
+
+#else
+
+bool HeadlessContext::Create(unsigned int, unsigned int, unsigned int)
+{
+  std::cout << "ERROR::HEADLESS_CONTEXT: Built without EGL support" << std::endl;
+  return false;
+}
+
+void HeadlessContext::Destroy()
+{
+}
+
+void *HeadlessContext::GetProcAddress(const char *)
+{
+  return nullptr;
+}
+
+#endif
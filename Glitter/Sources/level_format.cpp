@@ -0,0 +1,132 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "level_format.hpp"
+
+const LevelTileInfo *DefaultTileTable()
+{
+  static LevelTileInfo table[256];
+  static bool initialized = false;
+  if (!initialized)
+  {
+    // every non-solid code without a colour of its own is white
+    for (LevelTileInfo &info : table)
+    {
+      info.Color[0] = info.Color[1] = info.Color[2] = 1.0f;
+      info.Solid = 0;
+    }
+    const float colors[6][3] = {
+        {1.0f, 1.0f, 1.0f},  // empty
+        {0.8f, 0.8f, 0.7f},  // solid
+        {0.2f, 0.8f, 0.2f},  // green
+        {0.2f, 0.2f, 0.8f},  // blue
+        {0.8f, 0.8f, 0.2f},  // yellow
+        {0.8f, 0.2f, 0.2f}}; // red
+    for (unsigned int code = 0; code < 6; ++code)
+      std::memcpy(table[code].Color, colors[code], sizeof(colors[code]));
+    table[1].Solid = 1;
+    initialized = true;
+  }
+  return table;
+}
+
+bool ParseLevelText(const char *text, size_t size, LevelTiles &tiles)
+{
+  tiles.Width = 0;
+  tiles.Height = 0;
+  tiles.Codes.clear();
+
+  const char *end = text + size;
+  unsigned int column = 0;
+  while (true)
+  {
+    bool atEnd = text == end;
+    if (atEnd || *text == '\n')
+    {
+      // the first row sets the width, shorter rows are padded with empty tiles
+      if (column > 0)
+      {
+        if (tiles.Height == 0)
+          tiles.Width = column;
+        tiles.Codes.resize(++tiles.Height * tiles.Width, 0);
+      }
+      column = 0;
+      if (atEnd)
+        break;
+      ++text;
+    }
+    else if (*text >= '0' && *text <= '9')
+    {
+      unsigned int code = 0;
+      while (text != end && *text >= '0' && *text <= '9')
+      {
+        if (code <= 255)
+          code = code * 10 + (*text - '0');
+        ++text;
+      }
+      if (code > 255)
+      {
+        std::cerr << "ERROR::LEVEL_FORMAT::PARSE::Invalid tile code: " << code << std::endl;
+        return false;
+      }
+      // tiles past the width of the first row are ignored
+      if (tiles.Height == 0 || column < tiles.Width)
+        tiles.Codes.push_back(static_cast<unsigned char>(code));
+      column++;
+    }
+    else
+      ++text;
+  }
+  return tiles.Width > 0 && tiles.Height > 0;
+}
+
+void CompileLevel(const LevelTiles &tiles, std::vector<unsigned char> &compiled)
+{
+  LevelFileHeader header;
+  std::memcpy(header.Magic, LEVEL_FILE_MAGIC, sizeof(header.Magic));
+  header.Version = LEVEL_FILE_VERSION;
+  header.Width = tiles.Width;
+  header.Height = tiles.Height;
+  header.BrickCount = 0;
+  for (unsigned char code : tiles.Codes)
+    header.BrickCount += code > 0;
+  header.TableOffset = sizeof(LevelFileHeader);
+  header.TilesOffset = header.TableOffset + 256 * sizeof(LevelTileInfo);
+
+  compiled.resize(header.TilesOffset + tiles.Codes.size());
+  std::memcpy(compiled.data(), &header, sizeof(header));
+  std::memcpy(compiled.data() + header.TableOffset, DefaultTileTable(), 256 * sizeof(LevelTileInfo));
+  std::memcpy(compiled.data() + header.TilesOffset, tiles.Codes.data(), tiles.Codes.size());
+}
+
+bool WriteCompiledLevel(const char *file, const LevelTiles &tiles)
+{
+  std::vector<unsigned char> compiled;
+  CompileLevel(tiles, compiled);
+  std::ofstream out(file, std::ios::binary);
+  out.write(reinterpret_cast<const char *>(compiled.data()), compiled.size());
+  if (!out)
+  {
+    std::cerr << "ERROR::LEVEL_FORMAT::WRITE::Failed to write compiled level: " << file << std::endl;
+    return false;
+  }
+  return true;
+}
+
+const LevelFileHeader *ReadCompiledLevel(const unsigned char *data, size_t size)
+{
+  if (size < sizeof(LevelFileHeader))
+    return nullptr;
+  const LevelFileHeader *header = reinterpret_cast<const LevelFileHeader *>(data);
+  if (std::memcmp(header->Magic, LEVEL_FILE_MAGIC, sizeof(header->Magic)) != 0)
+    return nullptr;
+  if (header->Version != LEVEL_FILE_VERSION ||
+      header->TableOffset + 256 * sizeof(LevelTileInfo) > size ||
+      header->TilesOffset + static_cast<size_t>(header->Width) * header->Height > size)
+  {
+    std::cerr << "ERROR::LEVEL_FORMAT::READ::Unsupported or truncated compiled level" << std::endl;
+    return nullptr;
+  }
+  return header;
+}
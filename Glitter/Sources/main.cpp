@@ -1,24 +1,187 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include "asset_watcher.hpp"
+#include "dynamic_resolution.hpp"
+#include "frame_capture.hpp"
 #include "game.hpp"
+#include "gl_object.hpp"
+#include "hash.hpp"
 #include "resource_manager.hpp"
+#include "headless_context.hpp"
+#include "render_stats.hpp"
+#include "replay.hpp"
+#include "rewind_buffer.hpp"
+#include "software_renderer.hpp"
+#include "spectator_renderer.hpp"
+#include "program_cache.hpp"
+#include "startup_timeline.hpp"
+#include "texture_cache.hpp"
+#include "vec_env.hpp"
 
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
 
 // GLFW function declarations
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode);
 
-// The Width of the screen
-const unsigned int SCREEN_WIDTH = 800;
-// The height of the screen
-const unsigned int SCREEN_HEIGHT = 600;
+// Headless render benchmark (--bench-render), scripted or driven by a replay, optionally
+// holding a frame time with dynamic resolution and capturing the frames
+int run_render_benchmark(unsigned int frames, bool checksum, const char *expectedChecksum,
+                         const Replay *replay, DynamicResolution *resolution, const char *captureFile);
+// Plays a replay without any window or GL context (--replay <file> --headless)
+int run_headless_replay(const Replay &replay);
+// Plays a replay headless and renders every tick on the CPU at a small resolution (--software <w>x<h>)
+int run_software_replay(const Replay &replay, unsigned int width, unsigned int height, unsigned int threads,
+                        bool checksum, const char *expectedChecksum);
+// Shows a batch of simulated sessions side by side in the window (--spectate <sessions>)
+int run_spectator(GLFWwindow *window, unsigned int sessions);
+// Compares the game's state hash against the one stored in the replay
+int check_replay_determinism(const Replay &replay);
+// Deletes every GL object while the context is current and reports any that are left
+int release_gl_objects();
+
+// Memory the rewind history (--rewind) may use
+const size_t REWIND_BUDGET = 8 << 20;
+// States the rewind history records (and scrubs through) per second, whatever the frame rate
+const float REWIND_RATE = 60.0f;
 
 Game Breakout(SCREEN_WIDTH, SCREEN_HEIGHT);
 
 int main(int argc, char *argv[])
 {
+    StartupTimeline::Begin();
+
+    // command line options
+    // --------------------
+    unsigned int benchFrames = 0;
+    bool benchChecksum = false;
+    const char *benchExpected = nullptr;
+    const char *recordFile = nullptr;
+    const char *replayFile = nullptr;
+    bool headless = false;
+    const char *packFile = nullptr;
+    bool textureCache = true;
+    bool programCache = true;
+    bool watchAssets = false;
+    float targetFrameMs = 0.0f;
+    float minRenderScale = 0.5f;
+    const char *captureFile = nullptr;
+    float rewindSeconds = 0.0f;
+    unsigned int softwareWidth = 0, softwareHeight = 0, softwareThreads = 1;
+    unsigned int spectateSessions = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--bench-render") == 0 && i + 1 < argc)
+            benchFrames = std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            recordFile = argv[++i];
+        else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            replayFile = argv[++i];
+        else if (std::strcmp(argv[i], "--pack") == 0 && i + 1 < argc)
+            packFile = argv[++i];
+        else if (std::strcmp(argv[i], "--capture") == 0 && i + 1 < argc)
+            captureFile = argv[++i];
+        else if (std::strcmp(argv[i], "--no-program-cache") == 0)
+            programCache = false;
+        else if (std::strcmp(argv[i], "--no-texture-cache") == 0)
+            textureCache = false;
+        else if (std::strcmp(argv[i], "--aa") == 0 && i + 1 < argc)
+        {
+            if (!AntiAliasing::Parse(argv[++i], Breakout.AntiAliasingMode))
+            {
+                std::cout << "ERROR::MAIN: Unknown anti-aliasing mode " << argv[i] << " (none, fxaa, msaa<samples>, ssaa2)" << std::endl;
+                return -1;
+            }
+        }
+        else if (std::strcmp(argv[i], "--dynamic-resolution") == 0 && i + 1 < argc)
+            targetFrameMs = static_cast<float>(std::atof(argv[++i]));
+        else if (std::strcmp(argv[i], "--min-render-scale") == 0 && i + 1 < argc)
+            minRenderScale = static_cast<float>(std::atof(argv[++i]));
+        else if (std::strcmp(argv[i], "--rewind") == 0 && i + 1 < argc)
+            rewindSeconds = static_cast<float>(std::atof(argv[++i]));
+        else if (std::strcmp(argv[i], "--software") == 0 && i + 1 < argc)
+        {
+            char *size = nullptr;
+            softwareWidth = std::strtoul(argv[++i], &size, 10);
+            softwareHeight = *size == 'x' ? std::strtoul(size + 1, nullptr, 10) : 0;
+            if (softwareWidth == 0 || softwareHeight == 0)
+            {
+                std::cout << "ERROR::MAIN: Software render size " << argv[i] << " isn't <width>x<height>" << std::endl;
+                return -1;
+            }
+        }
+        else if (std::strcmp(argv[i], "--software-threads") == 0 && i + 1 < argc)
+            softwareThreads = std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--spectate") == 0 && i + 1 < argc)
+            spectateSessions = std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--watch") == 0)
+            watchAssets = true;
+        else if (std::strcmp(argv[i], "--serial-load") == 0)
+            ResourceManager::ParallelLoading = false;
+        else if (std::strcmp(argv[i], "--headless") == 0)
+            headless = true;
+        else if (std::strcmp(argv[i], "--checksum") == 0)
+            benchChecksum = true;
+        else if (std::strcmp(argv[i], "--expect-checksum") == 0 && i + 1 < argc)
+        {
+            benchChecksum = true;
+            benchExpected = argv[++i];
+        }
+        else
+        {
+            std::cout << "Usage: " << argv[0] << " [--pack <file>] [--serial-load] [--no-texture-cache] [--no-program-cache] [--watch] [--aa <mode>] [--dynamic-resolution <target ms> [--min-render-scale <scale>]] [--capture <file.y4m|prefix>] [--rewind <seconds>] [--record <file>]\n"
+                      << "       " << argv[0] << " --spectate <sessions>\n"
+                      << "       " << argv[0] << " --replay <file> [--headless [--software <w>x<h> [--software-threads <n>] [--checksum] [--expect-checksum <hex>]]]\n"
+                      << "       " << argv[0] << " --bench-render <frames> [--aa <mode>] [--dynamic-resolution <target ms>] [--capture <file.y4m|prefix>] [--replay <file>] [--checksum] [--expect-checksum <hex>]" << std::endl;
+            return -1;
+        }
+    }
+
+    // asset pack, by default the assets.pak built next to the executable; without
+    // one assets are read from the source tree and decoded images are cached
+    // next to the executable. Watched assets are always read from the source tree
+    // -----------------------------------------------------------------------
+    std::string exePath = argv[0];
+    size_t slash = exePath.find_last_of("/\\");
+    std::string exeDir = slash == std::string::npos ? std::string(".") : exePath.substr(0, slash);
+    if (packFile)
+    {
+        if (!ResourceManager::MountPack(packFile))
+            return -1;
+    }
+    else if (!watchAssets)
+        ResourceManager::Pack.Open((exeDir + "/assets.pak").c_str());
+    if (watchAssets && packFile)
+        std::cout << "WARNING::MAIN::Packed assets aren't reloaded, only edits to files missing from the pack are picked up" << std::endl;
+    if (textureCache)
+        TextureCache::Enable(exeDir + "/TextureCache");
+    if (programCache)
+        ProgramCache::Enable(exeDir + "/ProgramCache");
+
+    Replay replay;
+    if (replayFile && !replay.Load(replayFile))
+        return -1;
+    // scales the scene's resolution between minRenderScale and 1 to hold the target frame time
+    std::unique_ptr<DynamicResolution> resolution;
+    if (targetFrameMs > 0.0f)
+        resolution.reset(new DynamicResolution(targetFrameMs, minRenderScale));
+    if (benchFrames > 0)
+        return run_render_benchmark(benchFrames, benchChecksum, benchExpected, replayFile ? &replay : nullptr,
+                                    resolution.get(), captureFile);
+    if (replayFile && headless && softwareWidth > 0)
+        return run_software_replay(replay, softwareWidth, softwareHeight, softwareThreads, benchChecksum, benchExpected);
+    if (replayFile && headless)
+        return run_headless_replay(replay);
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -27,9 +190,12 @@ int main(int argc, char *argv[])
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
     glfwWindowHint(GLFW_RESIZABLE, false);
+    // multisampled for MSAA, as the game renders straight into it when no effect is active
+    glfwWindowHint(GLFW_SAMPLES, Breakout.AntiAliasingMode.WindowSamples());
 
     GLFWwindow *window = glfwCreateWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Breakout", nullptr, nullptr);
     glfwMakeContextCurrent(window);
+    StartupTimeline::Mark("window created");
 
     // glad: load all OpenGL function pointers
     // ---------------------------------------
@@ -52,11 +218,72 @@ int main(int argc, char *argv[])
     // initialize game
     // ---------------
     Breakout.Init();
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    Breakout.SetFramebufferSize(framebufferWidth, framebufferHeight);
+    StartupTimeline::Mark("game initialized");
+
+    // watch a batch of simulated sessions instead of playing
+    // -------------------------------------------------------
+    if (spectateSessions > 0)
+    {
+        int result = run_spectator(window, spectateSessions);
+        if (release_gl_objects() != 0)
+            result = -1;
+        glfwTerminate();
+        return result;
+    }
+
+    if (replayFile && !replay.Start(Breakout))
+    {
+        release_gl_objects();
+        glfwTerminate();
+        return -1;
+    }
+    if (!replayFile && recordFile)
+        replay.Begin(Breakout, static_cast<unsigned int>(std::time(nullptr)));
+    unsigned int tick = 0;
+
+    // reload assets as they're saved
+    // ------------------------------
+    AssetWatcher watcher;
+    if (watchAssets)
+        watcher.Start(ResourceManager::AssetRoot, {"Shaders", "Textures", "Levels"});
+    std::vector<std::string> changedAssets;
+
+    // time each frame on the GPU for dynamic resolution
+    // --------------------------------------------------
+    std::unique_ptr<GpuTimer> gpuTimer;
+    if (resolution)
+        gpuTimer.reset(new GpuTimer("frame timer"));
+
+    // record the frames for QA and bug reports
+    // ----------------------------------------
+    FrameCapture capture;
+    if (captureFile && !capture.Start(captureFile, framebufferWidth, framebufferHeight))
+    {
+        gpuTimer.reset();
+        release_gl_objects();
+        glfwTerminate();
+        return -1;
+    }
+
+    // keep the last seconds of play to scrub through; a replay has to play every
+    // tick in order, so there's no rewinding while recording or replaying
+    // ------------------------------------------------------------------------
+    std::unique_ptr<RewindBuffer> rewind;
+    if (rewindSeconds > 0.0f && (replayFile || recordFile))
+        std::cout << "WARNING::MAIN::Rewinding is disabled while recording or replaying" << std::endl;
+    else if (rewindSeconds > 0.0f)
+        rewind.reset(new RewindBuffer(static_cast<unsigned int>(rewindSeconds * REWIND_RATE), REWIND_BUDGET));
+    // time since the history last advanced
+    float rewindClock = 0.0f;
 
     // deltaTime variables
     // -------------------
     float deltaTime = 0.0f;
     float lastFrame = 0.0f;
+    bool firstFrame = true;
 
     while (!glfwWindowShouldClose(window))
     {
@@ -67,29 +294,105 @@ int main(int argc, char *argv[])
         lastFrame = currentFrame;
         glfwPollEvents();
 
-        // manage user input
-        // -----------------
-        Breakout.ProcessInput(deltaTime);
+        // swap in changed assets between frames, the watcher only queues their names
+        // ---------------------------------------------------------------------------
+        if (watchAssets && watcher.Poll(changedAssets))
+        {
+            Breakout.ReloadAssets(changedAssets);
+            changedAssets.clear();
+        }
 
-        // update game state
-        // -----------------
-        Breakout.Update(deltaTime);
+        // replays feed recorded input and time steps, recordings capture them
+        // --------------------------------------------------------------------
+        if (replayFile)
+        {
+            if (tick == replay.Ticks.size())
+                break;
+            replay.Apply(Breakout, tick);
+            deltaTime = replay.Ticks[tick++].DeltaTime;
+        }
+        else if (recordFile)
+            replay.Record(Breakout, deltaTime);
+
+        // hold [ to step back through the history, ] to step forward again; playing
+        // on from an earlier tick drops the ticks after it. The history records and
+        // scrubs at REWIND_RATE states a second, so high refresh rates don't shorten it
+        // -------------------------------------------------------------------------
+        bool rewindStep = false;
+        if (rewind)
+        {
+            rewindClock += deltaTime;
+            rewindStep = rewindClock >= 1.0f / REWIND_RATE;
+            if (rewindStep)
+                rewindClock = std::fmod(rewindClock, 1.0f / REWIND_RATE);
+        }
+        if (rewind && !rewind->Empty() &&
+            (Breakout.Keys[GLFW_KEY_LEFT_BRACKET] || Breakout.Keys[GLFW_KEY_RIGHT_BRACKET]))
+        {
+            unsigned int position = rewind->Position();
+            if (rewindStep && Breakout.Keys[GLFW_KEY_LEFT_BRACKET] && position > rewind->First())
+                rewind->Seek(Breakout, position - 1);
+            else if (rewindStep && Breakout.Keys[GLFW_KEY_RIGHT_BRACKET] && position < rewind->Last())
+                rewind->Seek(Breakout, position + 1);
+        }
+        else
+        {
+            // manage user input
+            // -----------------
+            Breakout.ProcessInput(deltaTime);
+
+            // update game state
+            // -----------------
+            Breakout.Update(deltaTime);
+            if (rewindStep)
+                rewind->Push(Breakout);
+        }
 
         // render
         // ------
+        if (gpuTimer)
+            gpuTimer->Begin();
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
-        Breakout.Render();
+        Breakout.Render(glfwGetTime());
+        if (gpuTimer)
+        {
+            gpuTimer->End();
+            // results arrive a few frames late, the scale applies from the next frame
+            float gpuMs;
+            if (gpuTimer->Result(gpuMs) && resolution->Update(gpuMs))
+                Breakout.SetRenderScale(resolution->Scale());
+        }
+        capture.Capture();
 
         glfwSwapBuffers(window);
+        if (firstFrame)
+        {
+            StartupTimeline::Mark("first frame presented");
+            StartupTimeline::Print();
+            firstFrame = false;
+        }
+    }
+
+    int result = 0;
+    if (replayFile && tick == replay.Ticks.size())
+        result = check_replay_determinism(replay);
+    else if (recordFile)
+    {
+        replay.FinalStateHash = Breakout.StateHash();
+        if (!replay.Save(recordFile))
+            result = -1;
     }
 
     // delete all resources as loaded using the resource manager
     // ---------------------------------------------------------
-    ResourceManager::Clear();
+    gpuTimer.reset();
+    capture.Stop();
+    if (release_gl_objects() != 0)
+        result = -1;
 
     glfwTerminate();
-    return 0;
+    return result;
 }
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode)
@@ -111,4 +414,282 @@ void framebuffer_size_callback(GLFWwindow *window, int width, int height)
     // make sure the viewport matches the new window dimensions; note that width and
     // height will be significantly larger than specified on retina displays.
     glViewport(0, 0, width, height);
-}
\ No newline at end of file
+    Breakout.SetFramebufferSize(width, height);
+}
+
+int run_render_benchmark(unsigned int frames, bool checksum, const char *expectedChecksum,
+                         const Replay *replay, DynamicResolution *resolution, const char *captureFile)
+{
+    // create an offscreen context instead of the GLFW window
+    // --------------------------------------------------------
+    HeadlessContext context;
+    if (!context.Create(SCREEN_WIDTH, SCREEN_HEIGHT, Breakout.AntiAliasingMode.WindowSamples()))
+        return -1;
+    if (!gladLoadGLLoader((GLADloadproc)HeadlessContext::GetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    StartupTimeline::Mark("context created");
+    glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    Breakout.Init();
+    StartupTimeline::Mark("game initialized");
+    if (replay)
+    {
+        if (!replay->Start(Breakout))
+        {
+            release_gl_objects();
+            return -1;
+        }
+        if (frames > replay->Ticks.size())
+            frames = replay->Ticks.size();
+    }
+
+    FrameCapture capture;
+    if (captureFile && !capture.Start(captureFile, SCREEN_WIDTH, SCREEN_HEIGHT))
+    {
+        release_gl_objects();
+        return -1;
+    }
+
+    // scripted sequence at a fixed time step: the ball is launched on the first frame, the
+    // paddle sweeps right and left, and each quarter of the run forces a different effect.
+    // With a replay, its recorded input and time steps are played instead.
+    // ---------------------------------------------------------------------------------------
+    float deltaTime = 1.0f / 60.0f;
+    float time = 0.0f;
+    unsigned long long drawCalls = 0, stateChanges = 0, shaderBinds = 0, textureBinds = 0;
+    double submitTotal = 0.0, submitMin = 1.0e9, submitMax = 0.0, frameTotal = 0.0;
+    double scaleTotal = 0.0, scaleMin = 1.0e9;
+    unsigned int framesOverTarget = 0;
+    for (unsigned int frame = 0; frame < frames; ++frame)
+    {
+        if (replay)
+        {
+            replay->Apply(Breakout, frame);
+            deltaTime = replay->Ticks[frame].DeltaTime;
+        }
+        else
+        {
+            unsigned int sweep = (frame / 45) % 4;
+            Breakout.Keys[GLFW_KEY_SPACE] = frame == 0;
+            Breakout.Keys[GLFW_KEY_RIGHT] = sweep == 0;
+            Breakout.Keys[GLFW_KEY_LEFT] = sweep == 2;
+            unsigned int quarter = frame * 4 / frames;
+            Breakout.Chaos = quarter == 1;
+            Breakout.Confuse = quarter == 2;
+            Breakout.Shake = quarter == 3;
+        }
+
+        Breakout.ProcessInput(deltaTime);
+        Breakout.Update(deltaTime);
+        time += deltaTime;
+
+        RenderStats::Reset();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        Breakout.Render(time);
+        capture.Capture();
+        std::chrono::steady_clock::time_point submitted = std::chrono::steady_clock::now();
+        // wait for the (software) GPU so frame time includes the actual rendering
+        glFinish();
+        std::chrono::steady_clock::time_point finished = std::chrono::steady_clock::now();
+        if (frame == 0)
+            StartupTimeline::Mark("first frame finished");
+
+        double submit = std::chrono::duration<double, std::milli>(submitted - start).count();
+        submitTotal += submit;
+        submitMin = submit < submitMin ? submit : submitMin;
+        submitMax = submit > submitMax ? submit : submitMax;
+        double frameMs = std::chrono::duration<double, std::milli>(finished - start).count();
+        frameTotal += frameMs;
+        // the finished frame time is what a GPU timer would measure here (llvmpipe's timer queries
+        // don't cover the rendering)
+        if (resolution)
+        {
+            double scale = resolution->Scale();
+            scaleTotal += scale;
+            scaleMin = scale < scaleMin ? scale : scaleMin;
+            framesOverTarget += frameMs > resolution->TargetMs;
+            if (resolution->Update(static_cast<float>(frameMs)))
+                Breakout.SetRenderScale(resolution->Scale());
+        }
+        drawCalls += RenderStats::DrawCalls;
+        stateChanges += RenderStats::StateChanges();
+        shaderBinds += RenderStats::ShaderBinds;
+        textureBinds += RenderStats::TextureBinds;
+    }
+
+    capture.Stop();
+    StartupTimeline::Print();
+    std::cout << "render benchmark: " << frames << " frames at " << SCREEN_WIDTH << "x" << SCREEN_HEIGHT
+              << " on " << glGetString(GL_RENDERER) << "\n"
+              << "  anti-aliasing:       " << Breakout.AntiAliasingMode.Name() << "\n"
+              << "  draw calls/frame:    " << static_cast<double>(drawCalls) / frames << "\n"
+              << "  state changes/frame: " << static_cast<double>(stateChanges) / frames
+              << " (shader binds " << static_cast<double>(shaderBinds) / frames
+              << ", texture binds " << static_cast<double>(textureBinds) / frames << ")\n"
+              << "  cpu submit ms:       avg " << submitTotal / frames
+              << ", min " << submitMin << ", max " << submitMax << "\n"
+              << "  frame ms (finished): avg " << frameTotal / frames << std::endl;
+    if (resolution)
+        std::cout << "  render scale:        avg " << scaleTotal / frames << ", min " << scaleMin
+                  << " (" << framesOverTarget << " frames over " << resolution->TargetMs << " ms)" << std::endl;
+    GLObjectStats::Print();
+
+    int result = 0;
+    if (checksum)
+    {
+        // FNV-1a over the final frame as a correctness guard
+        std::vector<unsigned char> pixels(SCREEN_WIDTH * SCREEN_HEIGHT * 4);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        unsigned long long hash = HASH_OFFSET_BASIS;
+        HashBytes(hash, pixels.data(), pixels.size());
+        std::cout << "  framebuffer checksum: " << std::hex << hash << std::dec << std::endl;
+        if (expectedChecksum && std::strtoull(expectedChecksum, nullptr, 16) != hash)
+        {
+            std::cout << "ERROR::BENCHMARK: Framebuffer checksum mismatch, expected " << expectedChecksum << std::endl;
+            result = 1;
+        }
+    }
+
+    if (replay && frames == replay->Ticks.size() && check_replay_determinism(*replay) != 0)
+        result = 1;
+
+    if (release_gl_objects() != 0)
+        result = 1;
+    return result;
+}
+
+int run_headless_replay(const Replay &replay)
+{
+    Breakout.InitHeadless();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (!replay.Simulate(Breakout))
+        return -1;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "headless replay: " << replay.Ticks.size() << " ticks in " << seconds * 1000.0
+              << " ms (" << replay.Ticks.size() / seconds << " ticks/s)" << std::endl;
+    return check_replay_determinism(replay);
+}
+
+int run_software_replay(const Replay &replay, unsigned int width, unsigned int height, unsigned int threads,
+                        bool checksum, const char *expectedChecksum)
+{
+    Breakout.InitHeadless();
+    SoftwareRenderer renderer(width, height, SCREEN_WIDTH, SCREEN_HEIGHT, threads);
+    if (!Game::LoadSoftwareTextures(renderer))
+        return -1;
+    if (!replay.Start(Breakout))
+        return -1;
+    double renderSeconds = 0.0;
+    for (unsigned int i = 0; i < replay.Ticks.size(); ++i)
+    {
+        replay.Apply(Breakout, i);
+        Breakout.ProcessInput(replay.Ticks[i].DeltaTime);
+        Breakout.Update(replay.Ticks[i].DeltaTime);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        Breakout.Render(renderer);
+        renderSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    std::cout << "software render: " << replay.Ticks.size() << " frames at " << width << "x" << height << " in "
+              << renderSeconds * 1000.0 << " ms (" << replay.Ticks.size() / renderSeconds << " frames/s)" << std::endl;
+
+    int result = check_replay_determinism(replay);
+    if (checksum)
+    {
+        // FNV-1a over the final frame, to check a change didn't alter what's drawn
+        unsigned long long hash = HASH_OFFSET_BASIS;
+        HashBytes(hash, renderer.Pixels(), static_cast<size_t>(width) * height * 3);
+        std::cout << "  frame checksum: " << std::hex << hash << std::dec << std::endl;
+        if (expectedChecksum && std::strtoull(expectedChecksum, nullptr, 16) != hash)
+        {
+            std::cout << "ERROR::SOFTWARE_RENDER: Frame checksum mismatch, expected " << expectedChecksum << std::endl;
+            result = 1;
+        }
+    }
+    return result;
+}
+
+int run_spectator(GLFWwindow *window, unsigned int sessions)
+{
+    Shader shader = ResourceManager::LoadShader("Shaders/spectator_shader.vert", "Shaders/spectator_shader.frag",
+                                                nullptr, "spectator");
+    int width, height;
+    glfwGetFramebufferSize(window, &width, &height);
+    glViewport(0, 0, width, height);
+    SpectatorRenderer wall(shader, width, height, SCREEN_WIDTH, SCREEN_HEIGHT);
+    wall.SetLayout(sessions);
+    Game::SetSpectatorTextures(wall);
+
+    // sessions follow the ball with a bit of noise, so they play out differently
+    VecEnv env(sessions, 0, static_cast<unsigned int>(std::time(nullptr)));
+    if (env.Sessions() != sessions)
+        return -1;
+    env.SetParticles(wall.Detailed());
+    std::vector<uint8_t> actions(sessions);
+    Random policy(static_cast<uint64_t>(std::time(nullptr)), STREAM_COSMETIC);
+    unsigned int drawCalls = 0;
+    while (!glfwWindowShouldClose(window))
+    {
+        glfwPollEvents();
+        for (unsigned int session = 0; session < sessions; ++session)
+        {
+            const float *observation = env.Observations() + session * OBS_FLOATS;
+            float paddle = observation[OBS_PADDLE_X] + observation[OBS_PADDLE_WIDTH] * 0.5f;
+            float ball = observation[OBS_BALL_X] + observation[OBS_BALL_RADIUS];
+            if (policy.NextBelow(10) == 0)
+                actions[session] = static_cast<uint8_t>(policy.NextBelow(ACTIONS));
+            else if (observation[OBS_BALL_STUCK] != 0.0f)
+                actions[session] = ACTION_LAUNCH;
+            else
+                actions[session] = ball < paddle - 10.0f ? ACTION_LEFT : ball > paddle + 10.0f ? ACTION_RIGHT : ACTION_NONE;
+        }
+        env.Step(actions.data());
+
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        RenderStats::Reset();
+        float time = static_cast<float>(glfwGetTime());
+        wall.Begin();
+        for (unsigned int session = 0; session < sessions; ++session)
+            env.Session(session).Render(wall, session, time);
+        wall.Finish();
+        drawCalls = RenderStats::DrawCalls;
+        glfwSwapBuffers(window);
+    }
+    std::cout << "spectator: " << sessions << " sessions in " << wall.Columns() << " columns, " << drawCalls
+              << " draw calls for " << wall.Instances() << " sprites in the last frame" << std::endl;
+    return 0;
+}
+
+int check_replay_determinism(const Replay &replay)
+{
+    unsigned long long hash = Breakout.StateHash();
+    if (replay.FinalStateHash == 0)
+        return 0;
+    if (hash != replay.FinalStateHash)
+    {
+        std::cout << "ERROR::REPLAY: Final state " << std::hex << hash << " differs from recorded "
+                  << replay.FinalStateHash << std::dec << std::endl;
+        return 1;
+    }
+    std::cout << "replay: final state matches recording (" << std::hex << hash << std::dec << ")" << std::endl;
+    return 0;
+}
+
+int release_gl_objects()
+{
+    Breakout.ReleaseRenderers();
+    ResourceManager::Clear();
+    if (GLObjectStats::Total().Objects() == 0)
+        return 0;
+    std::cout << "ERROR::MAIN: GL objects still alive at shutdown" << std::endl;
+    GLObjectStats::Print();
+    return 1;
+}
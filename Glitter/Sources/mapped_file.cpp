@@ -0,0 +1,106 @@
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : data(nullptr), size(0)
+#ifdef _WIN32
+      ,
+      fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+  Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const char *file)
+{
+  Close();
+  fileHandle = CreateFileA(file, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (fileHandle == INVALID_HANDLE_VALUE)
+    return false;
+  LARGE_INTEGER fileSize;
+  GetFileSizeEx(fileHandle, &fileSize);
+  size = static_cast<size_t>(fileSize.QuadPart);
+  if (size == 0)
+    return true;
+  mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mappingHandle)
+    data = static_cast<const unsigned char *>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+  if (!data)
+  {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void MappedFile::Close()
+{
+  if (data)
+    UnmapViewOfFile(data);
+  if (mappingHandle)
+    CloseHandle(mappingHandle);
+  if (fileHandle != INVALID_HANDLE_VALUE)
+    CloseHandle(fileHandle);
+  data = nullptr;
+  size = 0;
+  mappingHandle = nullptr;
+  fileHandle = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool MappedFile::Open(const char *file)
+{
+  Close();
+  int fd = open(file, O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat info;
+  if (fstat(fd, &info) != 0)
+  {
+    close(fd);
+    return false;
+  }
+  size = static_cast<size_t>(info.st_size);
+  if (size > 0)
+  {
+    void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED)
+    {
+      close(fd);
+      size = 0;
+      return false;
+    }
+    data = static_cast<const unsigned char *>(mapped);
+  }
+  // the mapping stays valid after the descriptor is closed
+  close(fd);
+  return true;
+}
+
+void MappedFile::Close()
+{
+  if (data)
+    munmap(const_cast<unsigned char *>(data), size);
+  data = nullptr;
+  size = 0;
+}
+
+#endif
@@ -1,21 +1,28 @@
 #include "particle_generator.hpp"
+#include "render_stats.hpp"
 
-ParticleGenerator::ParticleGenerator(Shader shader, Texture2D texture, unsigned int nr_particles)
-    : ParticleShader(shader), ParticleTex(texture)
+// Side of a particle's quad, the scale in particle_shader.vert
+const float PARTICLE_SIZE = 4.0f;
+
+ParticleGenerator::ParticleGenerator(Shader shader, Texture2D texture, unsigned int nr_particles,
+                                     Random &random)
+    : ParticleShader(shader), ParticleTex(texture), random(random)
 {
   for (unsigned int i = 0; i < nr_particles; ++i)
     particles.push_back(Particle());
-
-  initRenderData();
 }
 
 void ParticleGenerator::Update(float dt, GameObject &object,
                                unsigned int nr_new_particles, glm::vec2 offset)
 {
+  // draw the two random values every new particle needs in one bulk fill
+  randomValues.resize(nr_new_particles * 2);
+  random.Fill(randomValues.data(), randomValues.size());
   for (unsigned int i = 0; i < nr_new_particles; ++i)
   {
     int unusedParticle = FirstUnusedParticle();
-    RespawnParticle(particles[unusedParticle], object, offset);
+    RespawnParticle(particles[unusedParticle], object, offset,
+                    randomValues[i * 2], randomValues[i * 2 + 1]);
   }
   // update all particles
   for (unsigned int i = 0; i < particles.size(); ++i)
@@ -32,7 +39,12 @@ void ParticleGenerator::Update(float dt, GameObject &object,
 
 void ParticleGenerator::Draw()
 {
+  // render data is created on the first draw so the simulation side (Update) never needs a GL context
+  if (!particleVAO)
+    initRenderData();
+
   glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+  RenderStats::BlendChanges++;
   ParticleShader.Use();
   for (Particle particle : particles)
   {
@@ -41,12 +53,33 @@ void ParticleGenerator::Draw()
       ParticleShader.SetVector2f("offset", particle.Position);
       ParticleShader.SetVector4f("color", particle.Color);
       ParticleTex.Bind();
-      glBindVertexArray(particleVAO);
+      glBindVertexArray(particleVAO.ID());
       glDrawArrays(GL_TRIANGLES, 0, 6);
       glBindVertexArray(0);
+      RenderStats::VertexArrayBinds += 2;
+      RenderStats::DrawCalls++;
     }
   }
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  RenderStats::BlendChanges++;
+}
+
+void ParticleGenerator::Draw(SoftwareRenderer &renderer, unsigned int texture) const
+{
+  for (const Particle &particle : particles)
+  {
+    if (particle.Life > 0.0f)
+      renderer.DrawParticle(texture, particle.Position, glm::vec2(PARTICLE_SIZE), particle.Color);
+  }
+}
+
+void ParticleGenerator::Draw(SpectatorRenderer &renderer, unsigned int tile, unsigned int texture) const
+{
+  for (const Particle &particle : particles)
+  {
+    if (particle.Life > 0.0f)
+      renderer.DrawParticle(tile, texture, particle.Position, glm::vec2(PARTICLE_SIZE), particle.Color);
+  }
 }
 
 /**
@@ -77,10 +110,11 @@ unsigned int ParticleGenerator::FirstUnusedParticle()
   return 0;
 }
 
-void ParticleGenerator::RespawnParticle(Particle &particle, GameObject &object, glm::vec2 offset)
+void ParticleGenerator::RespawnParticle(Particle &particle, GameObject &object, glm::vec2 offset,
+                                        uint32_t randomOffset, uint32_t randomColor)
 {
-  float random = ((rand() % 100) - 50) / 10.0f;
-  float rColor = 0.5f + ((rand() % 100) / 100.0f);
+  float random = (static_cast<int>(randomOffset % 100) - 50) / 10.0f;
+  float rColor = 0.5f + ((randomColor % 100) / 100.0f);
   particle.Position = object.Position + random + offset;
   particle.Color = glm::vec4(rColor, rColor, rColor, 1.0f);
   particle.Life = 1.0f;
@@ -90,7 +124,6 @@ void ParticleGenerator::RespawnParticle(Particle &particle, GameObject &object,
 void ParticleGenerator::initRenderData()
 {
   // Configure VAO/VBO for particle rendering
-  unsigned int VBO;
   float vertices[] = {
       // pos      // tex
       0.0f, 1.0f, 0.0f, 1.0f,
@@ -101,13 +134,14 @@ void ParticleGenerator::initRenderData()
       1.0f, 1.0f, 1.0f, 1.0f,
       1.0f, 0.0f, 1.0f, 0.0f};
 
-  glGenVertexArrays(1, &particleVAO);
-  glGenBuffers(1, &VBO);
+  particleVAO = GLObject(GL_OBJECT_VERTEX_ARRAY, "particles");
+  particleVBO = GLObject(GL_OBJECT_BUFFER, "particles");
 
-  glBindVertexArray(particleVAO);
+  glBindVertexArray(particleVAO.ID());
 
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
+  glBindBuffer(GL_ARRAY_BUFFER, particleVBO.ID());
   glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+  particleVBO.SetBytes(sizeof(vertices));
 
   // Position + texture attributes
   glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)0);
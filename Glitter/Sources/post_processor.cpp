@@ -1,32 +1,131 @@
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <map>
+#include <set>
 
 #include "post_processor.hpp"
+#include "render_stats.hpp"
 
-PostProcessor::PostProcessor(Shader shader, unsigned int width, unsigned int height)
-    : PostProcessingShader(shader), Texture(),
-      Width(width), Height(height), Confuse(false), Chaos(false), Shake(false)
-{
-  glGenFramebuffers(1, &MSFBO);
-  glGenFramebuffers(1, &FBO);
-  glGenRenderbuffers(1, &RBO);
+// the default framebuffer, where every frame ends up
+static const std::string BACKBUFFER = "backbuffer";
+
+// scene -> resolve -> effects -> upscale -> backbuffer. At full resolution the upscale is culled,
+// and without effects the effects pass is culled too, which leaves the resolve copying straight
+// into the default framebuffer; that is culled as well and the scene is drawn into the default
+// framebuffer directly (unless it's supersampled)
+const PostProcessor::Pass PostProcessor::graph[] = {
+    {"scene", PASS_SCENE, nullptr, "scene"},
+    {"resolve", PASS_RESOLVE, "scene", "resolved"},
+    {"effects", PASS_EFFECTS, "resolved", "effected"},
+    {"upscale", PASS_UPSCALE, "effected", "backbuffer"}};
+const unsigned int PostProcessor::graphSize = sizeof(graph) / sizeof(graph[0]);
 
-  glBindFramebuffer(GL_FRAMEBUFFER, MSFBO);
-  glBindRenderbuffer(GL_RENDERBUFFER, RBO);
-  glRenderbufferStorageMultisample(GL_RENDERBUFFER, 4, GL_RGB, width, height);
-  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, RBO);
-  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-    std::cout << "ERROR::POSTPROCESSOR: Failed to initialize MSFBO" << std::endl;
+bool AntiAliasing::Parse(const char *text, AntiAliasing &antiAliasing)
+{
+  if (std::strcmp(text, "none") == 0)
+    antiAliasing = AntiAliasing(AA_NONE, 1);
+  else if (std::strcmp(text, "fxaa") == 0)
+    antiAliasing = AntiAliasing(AA_FXAA, 1);
+  else if (std::strncmp(text, "msaa", 4) == 0 && std::atoi(text + 4) > 1)
+    antiAliasing = AntiAliasing(AA_MSAA, std::atoi(text + 4));
+  // the supersampled scene is resolved with one bilinear blit, which averages 2x2 texels,
+  // so larger factors would skip texels instead of filtering them
+  else if (std::strcmp(text, "ssaa2") == 0)
+    antiAliasing = AntiAliasing(AA_SSAA, 2);
+  else
+    return false;
+  return true;
+}
 
-  glBindFramebuffer(GL_FRAMEBUFFER, FBO);
-  Texture.Generate(width, height, NULL);
-  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, Texture.ID, 0);
-  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-    std::cout << "ERROR::POSTPROCESSOR: Failed to initialize FBO" << std::endl;
+std::string AntiAliasing::Name() const
+{
+  switch (Mode)
+  {
+  case AA_MSAA:
+    return "msaa" + std::to_string(Factor);
+  case AA_SSAA:
+    return "ssaa" + std::to_string(Factor);
+  case AA_FXAA:
+    return "fxaa";
+  default:
+    return "none";
+  }
+}
 
+PostProcessor::PostProcessor(const Shader shaders[POST_EFFECT_COMBINATIONS], unsigned int width, unsigned int height,
+                             const AntiAliasing &antiAliasing)
+    : Width(width), Height(height), Confuse(false), Chaos(false), Shake(false),
+      compiledFor(~0u), renderScale(1.0f), compiledScale(1.0f), targets("post", width, height),
+      antiAliasing(antiAliasing)
+{
+  GLint samples = 0;
   glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glGetIntegerv(GL_SAMPLES, &samples);
+  backbufferSamples = samples > 1 ? samples : 1;
+  if (antiAliasing.Mode != AA_MSAA && backbufferSamples > 1)
+    std::cout << "ERROR::POSTPROCESSOR: Multisampled default framebuffer without MSAA" << std::endl;
+  // offscreen targets can't have more samples than the implementation supports
+  GLint maxSamples = 0;
+  glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+  if (antiAliasing.Mode == AA_MSAA && this->antiAliasing.Factor > static_cast<unsigned int>(maxSamples))
+  {
+    std::cout << "ERROR::POSTPROCESSOR: " << antiAliasing.Name() << " not supported, using msaa" << maxSamples << std::endl;
+    this->antiAliasing.Factor = maxSamples;
+  }
 
+  for (unsigned int variant = 0; variant < POST_EFFECT_COMBINATIONS; ++variant)
+    Shaders[variant] = shaders[variant];
   initRenderData();
-  PostProcessingShader.SetInteger("scene", 0, true);
+  ConfigureShaders();
+}
+
+unsigned int PostProcessor::Variant(unsigned int effects)
+{
+  if (effects & POST_EFFECT_CHAOS)
+    effects &= ~POST_EFFECT_CONFUSE;
+  return effects;
+}
+
+std::string PostProcessor::VariantName(unsigned int variant)
+{
+  std::string name = "effects";
+  if (variant & POST_EFFECT_CHAOS)
+    name += "_chaos";
+  if (variant & POST_EFFECT_CONFUSE)
+    name += "_confuse";
+  if (variant & POST_EFFECT_SHAKE)
+    name += "_shake";
+  if (variant & POST_EFFECT_FXAA)
+    name += "_fxaa";
+  return name;
+}
+
+std::string PostProcessor::VariantDefines(unsigned int variant)
+{
+  std::string defines;
+  if (variant & POST_EFFECT_CHAOS)
+    defines += "#define CHAOS\n";
+  if (variant & POST_EFFECT_CONFUSE)
+    defines += "#define CONFUSE\n";
+  if (variant & POST_EFFECT_SHAKE)
+    defines += "#define SHAKE\n";
+  if (variant & POST_EFFECT_FXAA)
+    defines += "#define FXAA\n";
+  return defines;
+}
+
+void PostProcessor::ConfigureShaders()
+{
+  for (Shader &shader : Shaders)
+    if (shader.ID)
+      configureShader(shader);
+}
+
+// uniforms a variant doesn't declare have no location, setting them does nothing
+void PostProcessor::configureShader(Shader &shader)
+{
+  shader.SetInteger("scene", 0, true);
 
   float offset = 1.0f / 300.0f;
   float offsets[9][2] = {
@@ -39,55 +138,210 @@ PostProcessor::PostProcessor(Shader shader, unsigned int width, unsigned int hei
       {-offset, -offset},
       {0.0f, -offset},
       {offset, -offset}};
-  glUniform2fv(glGetUniformLocation(PostProcessingShader.ID, "offsets"), 9, (float *)offsets);
+  glUniform2fv(glGetUniformLocation(shader.ID, "offsets"), 9, (float *)offsets);
 
   int edge_kernel[9] = {
       -1, -1, -1,
       -1, 8, -1,
       -1, -1, -1};
-  glUniform1iv(glGetUniformLocation(PostProcessingShader.ID, "edge_kernel"), 9, edge_kernel);
+  glUniform1iv(glGetUniformLocation(shader.ID, "edge_kernel"), 9, edge_kernel);
 
   float blur_kernel[9] = {
       1.0f / 16.0f, 2.0f / 16.0f, 1.0f / 16.0f,
       2.0f / 16.0f, 4.0f / 16.0f, 2.0f / 16.0f,
       1.0f / 16.0f, 2.0f / 16.0f, 1.0f / 16.0f};
-  glUniform1fv(glGetUniformLocation(PostProcessingShader.ID, "blur_kernel"), 9, blur_kernel);
+  glUniform1fv(glGetUniformLocation(shader.ID, "blur_kernel"), 9, blur_kernel);
+}
+
+void PostProcessor::Resize(unsigned int width, unsigned int height)
+{
+  Width = width;
+  Height = height;
+  compiled.clear();
+  targets.Resize(width, height);
+  compiledFor = ~0u;
 }
 
 void PostProcessor::BeginRender()
 {
-  glBindFramebuffer(GL_FRAMEBUFFER, MSFBO);
+  unsigned int enabledPasses = 0;
+  for (unsigned int i = 0; i < graphSize; ++i)
+    if (enabled(graph[i]))
+      enabledPasses |= 1u << i;
+  if (renderScale != compiledScale)
+  {
+    // every intermediate target is sized by the scale, the old ones won't be needed again
+    targets.Clear();
+    compiledFor = ~0u;
+    compiledScale = renderScale;
+  }
+  if (enabledPasses != compiledFor)
+  {
+    compile();
+    compiledFor = enabledPasses;
+  }
+
+  bindOutput(compiled[0]);
   glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
   glClear(GL_COLOR_BUFFER_BIT);
 }
 
-void PostProcessor::EndRender()
+void PostProcessor::EndRender(float time)
 {
-  glBindFramebuffer(GL_READ_FRAMEBUFFER, MSFBO);
-  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, FBO);
-  glBlitFramebuffer(0, 0, Width, Height, 0, 0, Width, Height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  for (size_t i = 1; i < compiled.size(); ++i)
+  {
+    const CompiledPass &pass = compiled[i];
+    if (pass.Source->Kind == PASS_RESOLVE)
+    {
+      // supersampled scenes are filtered down to the output's size
+      unsigned int width = pass.Output ? pass.Output->Width : Width;
+      unsigned int height = pass.Output ? pass.Output->Height : Height;
+      bool scaled = width != pass.Input->Width || height != pass.Input->Height;
+      glBindFramebuffer(GL_READ_FRAMEBUFFER, pass.Input->Framebuffer.ID());
+      glBindFramebuffer(GL_DRAW_FRAMEBUFFER, pass.Output ? pass.Output->Framebuffer.ID() : 0);
+      glBlitFramebuffer(0, 0, pass.Input->Width, pass.Input->Height, 0, 0, width, height,
+                        GL_COLOR_BUFFER_BIT, scaled ? GL_LINEAR : GL_NEAREST);
+      RenderStats::FramebufferBinds += 2;
+    }
+    else
+    {
+      // the upscale draws the plain variant, sampling with linear filtering
+      bindOutput(pass);
+      Shader &shader = Shaders[pass.Source->Kind == PASS_EFFECTS ? Variant(effects()) : 0];
+      shader.Use();
+      if (pass.Source->Kind == PASS_EFFECTS)
+      {
+        shader.SetFloat("time", time);
+        if (antiAliasing.Mode == AA_FXAA)
+          shader.SetVector2f("inverseSize", 1.0f / pass.Input->Width, 1.0f / pass.Input->Height);
+      }
+
+      glActiveTexture(GL_TEXTURE0);
+      pass.Input->Texture.Bind();
+      glBindVertexArray(VAO.ID());
+      glDrawArrays(GL_TRIANGLES, 0, 6);
+      glBindVertexArray(0);
+      RenderStats::VertexArrayBinds += 2;
+      RenderStats::DrawCalls++;
+    }
+  }
+  // leave the default framebuffer bound
+  if (compiled.back().Output)
+  {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    RenderStats::FramebufferBinds++;
+  }
 }
 
-void PostProcessor::Render(float time)
+std::vector<const char *> PostProcessor::ActivePasses() const
 {
-  PostProcessingShader.Use();
-  PostProcessingShader.SetFloat("time", time);
-  PostProcessingShader.SetInteger("confuse", Confuse);
-  PostProcessingShader.SetInteger("chaos", Chaos);
-  PostProcessingShader.SetInteger("shake", Shake);
+  std::vector<const char *> names;
+  for (const CompiledPass &pass : compiled)
+    names.push_back(pass.Source->Name);
+  return names;
+}
 
-  glActiveTexture(GL_TEXTURE0);
-  Texture.Bind();
-  glBindVertexArray(VAO);
-  glDrawArrays(GL_TRIANGLES, 0, 6);
-  glBindVertexArray(0);
+bool PostProcessor::enabled(const Pass &pass) const
+{
+  if (pass.Kind == PASS_EFFECTS)
+    return effects() != 0;
+  if (pass.Kind == PASS_UPSCALE)
+    return renderScale != 1.0f;
+  return true;
 }
 
-void PostProcessor::initRenderData()
+unsigned int PostProcessor::effects() const
+{
+  return (Chaos ? POST_EFFECT_CHAOS : 0) | (Confuse ? POST_EFFECT_CONFUSE : 0) | (Shake ? POST_EFFECT_SHAKE : 0) |
+         (antiAliasing.Mode == AA_FXAA ? POST_EFFECT_FXAA : 0);
+}
+
+RenderTargetDesc PostProcessor::describe(const std::string &target) const
+{
+  if (target == BACKBUFFER)
+    return RenderTargetDesc(backbufferSamples, GL_RGBA);
+  if (target == "scene")
+  {
+    if (antiAliasing.Mode == AA_MSAA)
+      return RenderTargetDesc(antiAliasing.Factor, GL_RGB, renderScale);
+    if (antiAliasing.Mode == AA_SSAA)
+      return RenderTargetDesc(1, GL_RGB, antiAliasing.Factor * renderScale);
+  }
+  return RenderTargetDesc(1, GL_RGB, renderScale);
+}
+
+bool PostProcessor::copyOnly(const Pass &pass, const std::string &output) const
+{
+  RenderTargetDesc input = describe(pass.Input);
+  RenderTargetDesc destination = describe(output);
+  return input.Samples == destination.Samples && input.Scale == destination.Scale;
+}
+
+void PostProcessor::compile()
+{
+  // walk back from the default framebuffer, keeping the passes that write something a later pass
+  // needs. A culled pass leaves its destination to the pass writing its input (aliasing that
+  // input to the destination); so does a resolve that is a plain copy (same samples and size),
+  // the pass before it can just as well render into the destination itself
+  std::map<std::string, std::string> alias;
+  std::set<std::string> required;
+  required.insert(BACKBUFFER);
+  std::vector<std::string> outputs(graphSize);
+  for (unsigned int i = graphSize; i-- > 0;)
+  {
+    const Pass &pass = graph[i];
+    std::map<std::string, std::string>::const_iterator aliased = alias.find(pass.Output);
+    std::string output = aliased != alias.end() ? aliased->second : pass.Output;
+    if (!required.count(output))
+      continue;
+    if (!enabled(pass) || (pass.Kind == PASS_RESOLVE && copyOnly(pass, output)))
+    {
+      if (pass.Input)
+        alias[pass.Input] = output;
+      continue;
+    }
+    outputs[i] = output;
+    if (pass.Input)
+      required.insert(pass.Input);
+  }
+
+  // assign render targets front to back. A target goes back to the pool after its last read, so
+  // a later pass with the same description reuses it
+  std::map<std::string, unsigned int> lastRead;
+  for (unsigned int i = 0; i < graphSize; ++i)
+    if (!outputs[i].empty() && graph[i].Input)
+      lastRead[graph[i].Input] = i;
+  std::map<std::string, RenderTarget *> written;
+  compiled.clear();
+  targets.ReleaseAll();
+  for (unsigned int i = 0; i < graphSize; ++i)
+  {
+    if (outputs[i].empty())
+      continue;
+    const Pass &pass = graph[i];
+    CompiledPass compiledPass;
+    compiledPass.Source = &pass;
+    compiledPass.Input = pass.Input ? written[pass.Input] : nullptr;
+    compiledPass.Output = outputs[i] == BACKBUFFER ? nullptr : targets.Acquire(describe(outputs[i]));
+    written[outputs[i]] = compiledPass.Output;
+    if (pass.Input && lastRead[pass.Input] == i)
+      targets.Release(compiledPass.Input);
+    compiled.push_back(compiledPass);
+  }
+}
+
+void PostProcessor::bindOutput(const CompiledPass &pass)
 {
-  unsigned int VBO;
+  glBindFramebuffer(GL_FRAMEBUFFER, pass.Output ? pass.Output->Framebuffer.ID() : 0);
+  RenderStats::FramebufferBinds++;
+  if (pass.Output)
+    glViewport(0, 0, pass.Output->Width, pass.Output->Height);
+  else
+    glViewport(0, 0, Width, Height);
+}
 
+void PostProcessor::initRenderData()
+{
   float vertices[] = {
       // pos        // tex
       -1.0f, -1.0f, 0.0f, 0.0f,
@@ -98,13 +352,14 @@ void PostProcessor::initRenderData()
       1.0f, -1.0f, 1.0f, 0.0f,
       1.0f, 1.0f, 1.0f, 1.0f};
 
-  glGenBuffers(1, &VBO);
-  glGenVertexArrays(1, &VAO);
+  VBO = GLObject(GL_OBJECT_BUFFER, "post");
+  VAO = GLObject(GL_OBJECT_VERTEX_ARRAY, "post");
 
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
+  glBindBuffer(GL_ARRAY_BUFFER, VBO.ID());
   glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+  VBO.SetBytes(sizeof(vertices));
 
-  glBindVertexArray(VAO);
+  glBindVertexArray(VAO.ID());
   glEnableVertexAttribArray(0);
   glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)0);
 
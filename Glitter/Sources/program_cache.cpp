@@ -0,0 +1,150 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#include "hash.hpp"
+#include "mapped_file.hpp"
+#include "program_cache.hpp"
+
+// Instantiate static variables
+std::string ProgramCache::Directory;
+
+bool ProgramCache::Enable(const std::string &directory)
+{
+#ifdef _WIN32
+  _mkdir(directory.c_str());
+#else
+  mkdir(directory.c_str(), 0755);
+#endif
+  struct stat info;
+  if (stat(directory.c_str(), &info) != 0 || !(info.st_mode & S_IFDIR))
+  {
+    std::cout << "ERROR::PROGRAM_CACHE::ENABLE::Failed to create cache directory: " << directory << std::endl;
+    Directory.clear();
+    return false;
+  }
+  Directory = directory;
+  return true;
+}
+
+bool ProgramCache::Load(const char *vertexSource, const char *fragmentSource, const char *geometrySource, Shader &shader)
+{
+  if (Directory.empty() || !supported())
+    return false;
+  uint64_t programKey = key(vertexSource, fragmentSource, geometrySource);
+  MappedFile entry;
+  if (!entry.Open(entryPath(programKey).c_str()))
+    return false;
+  const ProgramCacheHeader *header = reinterpret_cast<const ProgramCacheHeader *>(entry.Data());
+  if (entry.Size() < sizeof(ProgramCacheHeader) ||
+      std::memcmp(header->Magic, PROGRAM_CACHE_MAGIC, sizeof(PROGRAM_CACHE_MAGIC)) != 0 ||
+      header->Version != PROGRAM_CACHE_VERSION || header->Key != programKey ||
+      entry.Size() < sizeof(ProgramCacheHeader) + header->Length)
+    return false;
+
+  unsigned int program = glCreateProgram();
+  glProgramBinary(program, header->Format, entry.Data() + sizeof(ProgramCacheHeader), header->Length);
+  int success;
+  glGetProgramiv(program, GL_LINK_STATUS, &success);
+  if (!success)
+  {
+    // rejected by the driver, compile from source and replace the entry
+    glDeleteProgram(program);
+    return false;
+  }
+  shader.ID = program;
+  return true;
+}
+
+bool ProgramCache::Store(const char *vertexSource, const char *fragmentSource, const char *geometrySource, const Shader &shader)
+{
+  if (Directory.empty() || !supported())
+    return false;
+  int length = 0;
+  glGetProgramiv(shader.ID, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+    return false;
+  std::vector<unsigned char> binary(length);
+  GLenum format;
+  glGetProgramBinary(shader.ID, length, &length, &format, binary.data());
+
+  ProgramCacheHeader header;
+  std::memcpy(header.Magic, PROGRAM_CACHE_MAGIC, sizeof(header.Magic));
+  header.Version = PROGRAM_CACHE_VERSION;
+  header.Format = format;
+  header.Length = length;
+  header.Key = key(vertexSource, fragmentSource, geometrySource);
+
+  // write to a temporary file of this process first so a concurrent launch never maps
+  // a partial entry, and two launches storing the same entry don't share a file
+  std::string path = entryPath(header.Key);
+  std::ostringstream temporaryName;
+  temporaryName << path << "." << getpid() << ".tmp";
+  std::string temporary = temporaryName.str();
+  std::ofstream file(temporary.c_str(), std::ios::binary);
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char *>(binary.data()), length);
+  file.close();
+  if (!file)
+  {
+    std::cout << "ERROR::PROGRAM_CACHE::STORE::Failed to write cache entry: " << temporary << std::endl;
+    std::remove(temporary.c_str());
+    return false;
+  }
+#ifdef _WIN32
+  std::remove(path.c_str());
+#endif
+  if (std::rename(temporary.c_str(), path.c_str()) != 0)
+  {
+    std::remove(temporary.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool ProgramCache::supported()
+{
+  int formats = 0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+  // clear the invalid enum error of contexts without program binaries
+  while (glGetError() != GL_NO_ERROR)
+    ;
+  return formats > 0;
+}
+
+uint64_t ProgramCache::key(const char *vertexSource, const char *fragmentSource, const char *geometrySource)
+{
+  // NUL separators keep e.g. "ab" + "c" and "a" + "bc" apart
+  unsigned long long hash = HASH_OFFSET_BASIS;
+  const char *parts[] = {vertexSource, fragmentSource, geometrySource,
+                         reinterpret_cast<const char *>(glGetString(GL_VENDOR)),
+                         reinterpret_cast<const char *>(glGetString(GL_RENDERER)),
+                         reinterpret_cast<const char *>(glGetString(GL_VERSION))};
+  for (const char *part : parts)
+  {
+    if (part)
+      HashBytes(hash, part, std::strlen(part) + 1);
+    else
+      HashBytes(hash, "", 1);
+  }
+  return hash;
+}
+
+std::string ProgramCache::entryPath(uint64_t key)
+{
+  std::ostringstream path;
+  path << Directory << "/" << std::hex << key << ".bprg";
+  return path.str();
+}
@@ -0,0 +1,55 @@
+#include "random.hpp"
+
+// splitmix64, expands a seed into well mixed state words
+static uint64_t SplitMix(uint64_t &x)
+{
+  uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+Random::Random(uint64_t seed, unsigned int stream)
+{
+  Seed(seed, stream);
+}
+
+void Random::Seed(uint64_t seed, unsigned int stream)
+{
+  // every stream and lane gets its own splitmix sequence
+  uint64_t x = seed ^ (static_cast<uint64_t>(stream) << 56);
+  for (unsigned int i = 0; i < 4; i += 2)
+  {
+    uint64_t z = SplitMix(x);
+    State[i] = static_cast<uint32_t>(z);
+    State[i + 1] = static_cast<uint32_t>(z >> 32);
+  }
+  for (unsigned int word = 0; word < 4; ++word)
+  {
+    for (unsigned int lane = 0; lane < 4; ++lane)
+      Lanes[word][lane] = static_cast<uint32_t>(SplitMix(x) >> 16);
+  }
+}
+
+void Random::Fill(uint32_t *values, size_t count)
+{
+  uint32_t *s0 = Lanes[0], *s1 = Lanes[1], *s2 = Lanes[2], *s3 = Lanes[3];
+  uint32_t block[4];
+  size_t i = 0;
+  while (i < count)
+  {
+    for (unsigned int lane = 0; lane < 4; ++lane)
+    {
+      block[lane] = rotl(s1[lane] * 5, 7) * 9;
+      uint32_t t = s1[lane] << 9;
+      s2[lane] ^= s0[lane];
+      s3[lane] ^= s1[lane];
+      s1[lane] ^= s2[lane];
+      s0[lane] ^= s3[lane];
+      s2[lane] ^= t;
+      s3[lane] = rotl(s3[lane], 11);
+    }
+    for (unsigned int lane = 0; lane < 4 && i < count; ++lane)
+      values[i++] = block[lane];
+  }
+}
@@ -0,0 +1,27 @@
+#include "render_stats.hpp"
+
+// Instantiate static variables
+unsigned int RenderStats::DrawCalls = 0;
+unsigned int RenderStats::ShaderBinds = 0;
+unsigned int RenderStats::TextureBinds = 0;
+unsigned int RenderStats::VertexArrayBinds = 0;
+unsigned int RenderStats::FramebufferBinds = 0;
+unsigned int RenderStats::BlendChanges = 0;
+unsigned int RenderStats::UniformUploads = 0;
+
+unsigned int RenderStats::StateChanges()
+{
+  return ShaderBinds + TextureBinds + VertexArrayBinds + FramebufferBinds +
+         BlendChanges + UniformUploads;
+}
+
+void RenderStats::Reset()
+{
+  DrawCalls = 0;
+  ShaderBinds = 0;
+  TextureBinds = 0;
+  VertexArrayBinds = 0;
+  FramebufferBinds = 0;
+  BlendChanges = 0;
+  UniformUploads = 0;
+}
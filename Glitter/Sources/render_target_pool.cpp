@@ -0,0 +1,84 @@
+#include <iostream>
+
+#include "render_target_pool.hpp"
+
+RenderTargetPool::RenderTargetPool(const char *subsystem, unsigned int width, unsigned int height)
+    : subsystem(subsystem), width(width), height(height)
+{
+}
+
+void RenderTargetPool::Resize(unsigned int width, unsigned int height)
+{
+  if (width == this->width && height == this->height)
+    return;
+  this->width = width;
+  this->height = height;
+  Clear();
+}
+
+RenderTarget *RenderTargetPool::Acquire(const RenderTargetDesc &desc)
+{
+  for (std::unique_ptr<RenderTarget> &target : targets)
+  {
+    if (!target->InUse && target->Desc == desc)
+    {
+      target->InUse = true;
+      return target.get();
+    }
+  }
+  targets.push_back(std::unique_ptr<RenderTarget>(new RenderTarget()));
+  RenderTarget &target = *targets.back();
+  target.Desc = desc;
+  create(target);
+  target.InUse = true;
+  return &target;
+}
+
+void RenderTargetPool::Release(RenderTarget *target)
+{
+  if (target)
+    target->InUse = false;
+}
+
+void RenderTargetPool::ReleaseAll()
+{
+  for (std::unique_ptr<RenderTarget> &target : targets)
+    target->InUse = false;
+}
+
+void RenderTargetPool::Clear()
+{
+  targets.clear();
+}
+
+void RenderTargetPool::create(RenderTarget &target)
+{
+  target.Width = static_cast<unsigned int>(width * target.Desc.Scale);
+  target.Height = static_cast<unsigned int>(height * target.Desc.Scale);
+  target.Framebuffer = GLObject(GL_OBJECT_FRAMEBUFFER, subsystem);
+  glBindFramebuffer(GL_FRAMEBUFFER, target.Framebuffer.ID());
+  // estimate 4 bytes per texel (RGB is usually stored padded), per sample
+  size_t bytes = static_cast<size_t>(target.Width) * target.Height * 4;
+  if (target.Desc.Samples > 1)
+  {
+    target.Storage = GLObject(GL_OBJECT_RENDERBUFFER, subsystem);
+    glBindRenderbuffer(GL_RENDERBUFFER, target.Storage.ID());
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, target.Desc.Samples, target.Desc.Format, target.Width, target.Height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target.Storage.ID());
+    target.Storage.SetBytes(bytes * target.Desc.Samples);
+  }
+  else
+  {
+    target.Storage = GLObject(GL_OBJECT_TEXTURE, subsystem);
+    target.Texture = Texture2D();
+    target.Texture.ID = target.Storage.ID();
+    target.Texture.Internal_Format = target.Desc.Format;
+    target.Texture.Image_Format = target.Desc.Format;
+    target.Texture.Generate(target.Width, target.Height, NULL);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.Texture.ID, 0);
+    target.Storage.SetBytes(bytes);
+  }
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    std::cout << "ERROR::RENDER_TARGET_POOL: Failed to initialize render target" << std::endl;
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
@@ -0,0 +1,148 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "replay.hpp"
+
+// Replay file layout (native byte order, packed):
+//   "BRPL" | version | seed | level | width | height | tick count   (uint32 each)
+//   final state hash                                                 (uint64)
+//   tick count x { delta time (float), input bits (uint8) }
+static const char REPLAY_MAGIC[4] = {'B', 'R', 'P', 'L'};
+static const unsigned int REPLAY_VERSION = 2;
+// bytes of a tick in the file: delta time and input bits
+static const unsigned int REPLAY_TICK_BYTES = sizeof(float) + sizeof(unsigned char);
+
+Replay::Replay()
+    : Seed(0), Level(0), Width(0), Height(0), FinalStateHash(0)
+{
+}
+
+void Replay::Begin(Game &game, unsigned int seed)
+{
+  Seed = seed;
+  Level = game.CurrentLevel;
+  Width = game.Width;
+  Height = game.Height;
+  Ticks.clear();
+  FinalStateHash = 0;
+  game.SetSeed(seed);
+}
+
+void Replay::Record(const Game &game, float dt)
+{
+  ReplayTick tick;
+  tick.DeltaTime = dt;
+  tick.Input = 0;
+  if (game.Keys[GLFW_KEY_A] || game.Keys[GLFW_KEY_LEFT])
+    tick.Input |= INPUT_LEFT;
+  if (game.Keys[GLFW_KEY_D] || game.Keys[GLFW_KEY_RIGHT])
+    tick.Input |= INPUT_RIGHT;
+  if (game.Keys[GLFW_KEY_SPACE])
+    tick.Input |= INPUT_LAUNCH;
+  Ticks.push_back(tick);
+}
+
+bool Replay::Start(Game &game) const
+{
+  if (Level >= game.Levels.size())
+  {
+    std::cerr << "ERROR::REPLAY: Recorded on level " << Level << ", the game has " << game.Levels.size()
+              << " levels" << std::endl;
+    return false;
+  }
+  if (game.Width != Width || game.Height != Height)
+    std::cerr << "WARNING::REPLAY: Recorded at " << Width << "x" << Height
+              << ", playing at " << game.Width << "x" << game.Height << std::endl;
+  game.CurrentLevel = Level;
+  game.SetSeed(Seed);
+  return true;
+}
+
+void Replay::Apply(Game &game, unsigned int tick) const
+{
+  unsigned char input = Ticks[tick].Input;
+  // overwrite every key ProcessInput reads, so live key presses can't leak into a replay
+  game.Keys[GLFW_KEY_A] = false;
+  game.Keys[GLFW_KEY_D] = false;
+  game.Keys[GLFW_KEY_LEFT] = (input & INPUT_LEFT) != 0;
+  game.Keys[GLFW_KEY_RIGHT] = (input & INPUT_RIGHT) != 0;
+  game.Keys[GLFW_KEY_SPACE] = (input & INPUT_LAUNCH) != 0;
+}
+
+bool Replay::Simulate(Game &game) const
+{
+  if (!Start(game))
+    return false;
+  for (unsigned int i = 0; i < Ticks.size(); ++i)
+  {
+    Apply(game, i);
+    game.ProcessInput(Ticks[i].DeltaTime);
+    game.Update(Ticks[i].DeltaTime);
+  }
+  return true;
+}
+
+bool Replay::Save(const char *file) const
+{
+  std::ofstream out(file, std::ios::binary);
+  if (!out)
+  {
+    std::cerr << "ERROR::REPLAY::SAVE::Failed to open replay file: " << file << std::endl;
+    return false;
+  }
+  unsigned int header[6] = {REPLAY_VERSION, Seed, Level, Width, Height,
+                            static_cast<unsigned int>(Ticks.size())};
+  out.write(REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+  out.write(reinterpret_cast<const char *>(header), sizeof(header));
+  out.write(reinterpret_cast<const char *>(&FinalStateHash), sizeof(FinalStateHash));
+  for (const ReplayTick &tick : Ticks)
+  {
+    out.write(reinterpret_cast<const char *>(&tick.DeltaTime), sizeof(tick.DeltaTime));
+    out.write(reinterpret_cast<const char *>(&tick.Input), sizeof(tick.Input));
+  }
+  return static_cast<bool>(out);
+}
+
+bool Replay::Load(const char *file)
+{
+  std::ifstream in(file, std::ios::binary);
+  char magic[4];
+  unsigned int header[6];
+  if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, REPLAY_MAGIC, sizeof(magic)) != 0 ||
+      !in.read(reinterpret_cast<char *>(header), sizeof(header)) || header[0] != REPLAY_VERSION)
+  {
+    std::cerr << "ERROR::REPLAY::LOAD::Failed to read replay file: " << file << std::endl;
+    return false;
+  }
+  Seed = header[1];
+  Level = header[2];
+  Width = header[3];
+  Height = header[4];
+  in.read(reinterpret_cast<char *>(&FinalStateHash), sizeof(FinalStateHash));
+
+  // the tick count has to fit the rest of the file before anything is allocated for it
+  std::streamoff start = in.tellg();
+  in.seekg(0, std::ios::end);
+  std::streamoff remaining = in.tellg() - start;
+  in.seekg(start);
+  if (!in || remaining < static_cast<std::streamoff>(header[5]) * REPLAY_TICK_BYTES)
+  {
+    std::cerr << "ERROR::REPLAY::LOAD::Truncated replay file: " << file << std::endl;
+    Ticks.clear();
+    return false;
+  }
+  Ticks.resize(header[5]);
+  for (ReplayTick &tick : Ticks)
+  {
+    in.read(reinterpret_cast<char *>(&tick.DeltaTime), sizeof(tick.DeltaTime));
+    in.read(reinterpret_cast<char *>(&tick.Input), sizeof(tick.Input));
+  }
+  if (!in)
+  {
+    std::cerr << "ERROR::REPLAY::LOAD::Truncated replay file: " << file << std::endl;
+    Ticks.clear();
+    return false;
+  }
+  return true;
+}
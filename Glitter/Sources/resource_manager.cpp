@@ -7,109 +7,430 @@
 ** option) any later version.
 ******************************************************************/
 #include "resource_manager.hpp"
+#include "program_cache.hpp"
+#include "startup_timeline.hpp"
+#include "texture_cache.hpp"
 
+#include <chrono>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <thread>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
 // Instantiate static variables
-std::map<std::string, Texture2D> ResourceManager::Textures;
-std::map<std::string, Shader> ResourceManager::Shaders;
+ResourceRegistry<Texture2D> ResourceManager::Textures;
+ResourceRegistry<Shader> ResourceManager::Shaders;
+std::string ResourceManager::AssetRoot = std::string(PROJECT_SOURCE_DIR) + "/Glitter";
+AssetPack ResourceManager::Pack;
+bool ResourceManager::ParallelLoading = true;
+std::vector<std::future<ResourceManager::TextureImage>> ResourceManager::pendingTextures;
+std::map<std::string, ResourceManager::ShaderFiles> ResourceManager::shaderFiles;
+std::map<std::string, ResourceManager::TextureFile> ResourceManager::textureFiles;
+std::unordered_map<unsigned long long, GLObject> ResourceManager::textureObjects;
+std::unordered_map<unsigned long long, GLObject> ResourceManager::programObjects;
+std::map<std::string, std::future<ResourceManager::LevelImage>> ResourceManager::pendingLevels;
+ResourceManager::LevelTemplates ResourceManager::levelTemplates;
 
-Shader &ResourceManager::LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name)
+bool ResourceManager::MountPack(const char *file)
 {
-  Shaders[name] = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile);
-  return Shaders[name];
+  if (!Pack.Open(file))
+  {
+    std::cout << "ERROR::RESOURCE_MANAGER::MOUNT_PACK::Failed to open asset pack: " << file << std::endl;
+    return false;
+  }
+  return true;
+}
+
+Shader &ResourceManager::LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name,
+                                    const std::string &defines)
+{
+  ShaderFiles &files = shaderFiles[name];
+  files.Vertex = vShaderFile;
+  files.Fragment = fShaderFile;
+  files.Geometry = gShaderFile ? gShaderFile : "";
+  files.Defines = defines;
+  Shader shader = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile, defines);
+  // replaces (and deletes) the program previously loaded under this name
+  programObjects[nameHash(name)] = GLObject(GL_OBJECT_PROGRAM, shader.ID, "shaders");
+  ShaderHandle handle = Shaders.Set(nameHash(name), shader);
+  StartupTimeline::Mark(("shader " + name).c_str());
+  return Shaders.Get(handle);
+}
+
+ShaderHandle ResourceManager::GetShaderHandle(const std::string &name)
+{
+  return GetShaderHandle(nameHash(name));
+}
+
+ShaderHandle ResourceManager::GetShaderHandle(unsigned long long nameHash)
+{
+  ShaderHandle handle = Shaders.Find(nameHash);
+  if (!handle.Valid())
+    handle = Shaders.Set(nameHash, Shader());
+  return handle;
 }
 
-Shader &ResourceManager::GetShader(std::string name)
+Shader &ResourceManager::GetShader(const std::string &name)
 {
-  return Shaders[name];
+  return Shaders.Get(GetShaderHandle(name));
 }
 
 Texture2D &ResourceManager::LoadTexture(const char *file, bool alpha, std::string name)
 {
-  Textures[name] = loadTextureFromFile(file, alpha);
-  return Textures[name];
+  textureFiles[name] = TextureFile(file, alpha);
+  GLObject &object = textureObjects[nameHash(name)];
+  return Textures.Get(Textures.Set(nameHash(name), loadTextureFromFile(file, alpha, object)));
 }
 
-Texture2D &ResourceManager::GetTexture(std::string name)
+bool ResourceManager::LoadImage(const char *file, bool alpha, std::vector<unsigned char> &texels,
+                                unsigned int &width, unsigned int &height)
 {
-  return Textures[name];
+  TextureImage image = decodeTexture(file, alpha, std::string());
+  if (!image.Pixels)
+  {
+    std::cout << "ERROR::RESOURCE_MANAGER::LOAD_IMAGE::Failed to decode image: " << file << std::endl;
+    return false;
+  }
+  width = image.Width;
+  height = image.Height;
+  texels.assign(image.Pixels, image.Pixels + static_cast<size_t>(width) * height * (alpha ? 4 : 3));
+  if (image.Owned)
+    stbi_image_free(const_cast<unsigned char *>(image.Pixels));
+  return true;
 }
 
-void ResourceManager::Clear()
+TextureHandle ResourceManager::GetTextureHandle(const std::string &name)
 {
-  // (properly) delete all shaders
-  for (auto iter : Shaders)
-    glDeleteProgram(iter.second.ID);
-  // (properly) delete all textures
-  for (auto iter : Textures)
-    glDeleteTextures(1, &iter.second.ID);
+  return GetTextureHandle(nameHash(name));
 }
 
-Shader ResourceManager::loadShaderFromFile(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile)
+TextureHandle ResourceManager::GetTextureHandle(unsigned long long nameHash)
 {
-  // 1. retrieve the vertex/fragment source code from filePath
-  std::string vertexCode;
-  std::string fragmentCode;
-  std::string geometryCode;
-  try
-  {
-    // open files
-    std::ifstream vertexShaderFile(vShaderFile);
-    std::ifstream fragmentShaderFile(fShaderFile);
-    std::stringstream vShaderStream, fShaderStream;
-    // read file's buffer contents into streams
-    vShaderStream << vertexShaderFile.rdbuf();
-    fShaderStream << fragmentShaderFile.rdbuf();
-    // close file handlers
-    vertexShaderFile.close();
-    fragmentShaderFile.close();
-    // convert stream into string
-    vertexCode = vShaderStream.str();
-    fragmentCode = fShaderStream.str();
-    // if geometry shader path is present, also load a geometry shader
-    if (gShaderFile != nullptr)
+  TextureHandle handle = Textures.Find(nameHash);
+  if (!handle.Valid())
+    handle = Textures.Set(nameHash, Texture2D());
+  return handle;
+}
+
+Texture2D &ResourceManager::GetTexture(const std::string &name)
+{
+  return Textures.Get(GetTextureHandle(name));
+}
+
+// worker threads only pay off with a core to spare, deferred tasks run when they're
+// finished, one after the other
+static std::launch loadPolicy()
+{
+  if (ResourceManager::ParallelLoading && std::thread::hardware_concurrency() > 1)
+    return std::launch::async;
+  return std::launch::deferred;
+}
+
+void ResourceManager::QueueTexture(const char *file, bool alpha, std::string name)
+{
+  textureFiles[name] = TextureFile(file, alpha);
+  pendingTextures.push_back(std::async(loadPolicy(), decodeTexture, std::string(file), alpha, name));
+}
+
+void ResourceManager::FinishTextures()
+{
+  while (!pendingTextures.empty())
+  {
+    // generate whichever decode is done first, otherwise block on the oldest one
+    size_t next = 0;
+    for (size_t i = 0; i < pendingTextures.size(); ++i)
     {
-      std::ifstream geometryShaderFile(gShaderFile);
-      std::stringstream gShaderStream;
-      gShaderStream << geometryShaderFile.rdbuf();
-      geometryShaderFile.close();
-      geometryCode = gShaderStream.str();
+      if (pendingTextures[i].wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+      {
+        next = i;
+        break;
+      }
     }
+    TextureImage image = pendingTextures[next].get();
+    pendingTextures.erase(pendingTextures.begin() + next);
+    Texture2D texture;
+    generateTexture(image, texture, textureObjects[nameHash(image.Name)]);
+    Textures.Set(nameHash(image.Name), texture);
+  }
+}
+
+void ResourceManager::QueueLevel(const char *file)
+{
+  // a level loaded before (by another session) has nothing left to compile
+  for (LevelTemplates::iterator iter = levelTemplates.begin(); iter != levelTemplates.end(); ++iter)
+  {
+    if (std::get<0>(iter->first) == file)
+      return;
+  }
+  pendingLevels[file] = std::async(loadPolicy(), compileLevel, std::string(file));
+}
+
+std::shared_ptr<const LevelTemplate> ResourceManager::LoadLevel(const char *file, unsigned int levelWidth, unsigned int levelHeight)
+{
+  LevelTemplates::key_type key = std::make_tuple(std::string(file), levelWidth, levelHeight);
+  std::shared_ptr<const LevelTemplate> &stored = levelTemplates[key];
+  if (stored)
+    return stored;
+
+  LevelImage image;
+  std::map<std::string, std::future<LevelImage>>::iterator pending = pendingLevels.find(file);
+  if (pending != pendingLevels.end())
+  {
+    image = pending->second.get();
+    pendingLevels.erase(pending);
+  }
+  else
+    image = compileLevel(file);
+
+  // bricks reference the block textures, so they're only built here once those exist
+  std::shared_ptr<LevelTemplate> level = std::make_shared<LevelTemplate>();
+  if (image.View)
+    level->Load(image.View, image.ViewSize, levelWidth, levelHeight);
+  else if (!image.Compiled.empty())
+    level->Load(image.Compiled.data(), image.Compiled.size(), levelWidth, levelHeight);
+  // a level that couldn't be read isn't kept, so it's read again next time (e.g. from another asset root)
+  if (level->Bricks.empty())
+  {
+    levelTemplates.erase(key);
+    return level;
   }
-  catch (std::exception e)
+  stored = level;
+  return stored;
+}
+
+void ResourceManager::Clear()
+{
+  // (properly) delete all shaders and textures
+  programObjects.clear();
+  textureObjects.clear();
+  // sessions keep the templates they hold
+  levelTemplates.clear();
+  // handles resolved so far go stale
+  Shaders.Clear();
+  Textures.Clear();
+}
+
+unsigned long long ResourceManager::nameHash(const std::string &name)
+{
+  // same hash as HashName, so compile-time hashed names find the same resources
+  unsigned long long hash = HASH_OFFSET_BASIS;
+  HashBytes(hash, name.data(), name.size());
+  return hash;
+}
+
+std::string ResourceManager::resolvePath(const char *file)
+{
+  if (file[0] == '/' || file[0] == '\\' || (file[0] != '\0' && file[1] == ':'))
+    return file;
+  return AssetRoot + "/" + file;
+}
+
+// returns a shader's source, either a view into the asset pack or read into storage. Defines are
+// inserted after the #version line (which has to come first), storage then holds the result
+static const char *shaderSource(const char *file, std::string &storage, const std::string &path, const std::string &defines)
+{
+  const char *source;
+  const AssetPackEntry *entry = ResourceManager::Pack.IsOpen() ? ResourceManager::Pack.Find(file) : nullptr;
+  if (entry && entry->Type == ASSET_SHADER)
+    source = reinterpret_cast<const char *>(ResourceManager::Pack.Data(*entry));
+  else
   {
-    std::cout << "ERROR::SHADER: Failed to read shader files" << std::endl;
+    std::ifstream shaderFile(path);
+    if (!shaderFile)
+      std::cout << "ERROR::SHADER: Failed to read shader file: " << path << std::endl;
+    std::stringstream shaderStream;
+    shaderStream << shaderFile.rdbuf();
+    storage = shaderStream.str();
+    source = storage.c_str();
   }
-  const char *vShaderCode = vertexCode.c_str();
-  const char *fShaderCode = fragmentCode.c_str();
-  const char *gShaderCode = geometryCode.c_str();
-  // 2. now create shader object from source code
+  if (defines.empty())
+    return source;
+
+  const char *versionEnd = std::strchr(source, '\n');
+  versionEnd = versionEnd ? versionEnd + 1 : source + std::strlen(source);
+  // #line keeps compile errors pointing at the lines of the file
+  std::string specialized(source, versionEnd);
+  specialized += defines;
+  specialized += "#line 2\n";
+  specialized += versionEnd;
+  storage.swap(specialized);
+  return storage.c_str();
+}
+
+Shader ResourceManager::loadShaderFromFile(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile,
+                                           const std::string &defines)
+{
+  // 1. retrieve the vertex/fragment (and geometry) source code from the pack or from disk
+  std::string vertexCode;
+  std::string fragmentCode;
+  std::string geometryCode;
+  const char *vShaderCode = shaderSource(vShaderFile, vertexCode, resolvePath(vShaderFile), defines);
+  const char *fShaderCode = shaderSource(fShaderFile, fragmentCode, resolvePath(fShaderFile), defines);
+  const char *gShaderCode = nullptr;
+  // if geometry shader path is present, also load a geometry shader
+  if (gShaderFile != nullptr)
+    gShaderCode = shaderSource(gShaderFile, geometryCode, resolvePath(gShaderFile), defines);
+  // 2. now create shader object from the cached program binary, or compile it from source code
   Shader shader;
-  shader.Compile(vShaderCode, fShaderCode, gShaderFile != nullptr ? gShaderCode : nullptr);
+  if (!ProgramCache::Load(vShaderCode, fShaderCode, gShaderCode, shader))
+  {
+    shader.Compile(vShaderCode, fShaderCode, gShaderCode);
+    ProgramCache::Store(vShaderCode, fShaderCode, gShaderCode, shader);
+  }
   return shader;
 }
 
-Texture2D ResourceManager::loadTextureFromFile(const char *file, bool alpha)
+Texture2D ResourceManager::loadTextureFromFile(const char *file, bool alpha, GLObject &object)
 {
   // create texture object
   Texture2D texture;
-  if (alpha)
+  TextureImage image = decodeTexture(file, alpha, std::string());
+  generateTexture(image, texture, object);
+  return texture;
+}
+
+ResourceManager::TextureImage ResourceManager::decodeTexture(std::string file, bool alpha, std::string name)
+{
+  TextureImage image;
+  image.Name = name;
+  image.Alpha = alpha;
+  // packed textures are already decoded, upload them straight from the mapping
+  const AssetPackEntry *entry = Pack.IsOpen() ? Pack.Find(file.c_str()) : nullptr;
+  if (entry && entry->Type == ASSET_TEXTURE)
+  {
+    image.Width = entry->Width;
+    image.Height = entry->Height;
+    image.Pixels = Pack.Data(*entry);
+    image.Owned = false;
+    return image;
+  }
+  // images decoded on an earlier launch are mapped from the texture cache
+  std::string path = resolvePath(file.c_str());
+  std::shared_ptr<MappedFile> cacheEntry(new MappedFile());
+  const TextureCacheHeader *cached = TextureCache::Load(path, *cacheEntry);
+  if (cached)
+  {
+    image.Width = cached->Width;
+    image.Height = cached->Height;
+    image.Pixels = cacheEntry->Data() + sizeof(TextureCacheHeader);
+    image.Owned = false;
+    image.CacheEntry = cacheEntry;
+    return image;
+  }
+  // load image
+  int nrChannels;
+  image.Pixels = stbi_load(path.c_str(), &image.Width, &image.Height, &nrChannels, 0);
+  image.Owned = true;
+  if (image.Pixels)
+    TextureCache::Store(path, image.Width, image.Height, nrChannels, image.Pixels);
+  return image;
+}
+
+void ResourceManager::generateTexture(TextureImage &image, Texture2D &texture, GLObject &object)
+{
+  if (!object)
+    object = GLObject(GL_OBJECT_TEXTURE, "textures");
+  texture.ID = object.ID();
+  if (image.Alpha)
   {
     texture.Internal_Format = GL_RGBA;
     texture.Image_Format = GL_RGBA;
   }
-  // load image
-  int width, height, nrChannels;
-  unsigned char *data = stbi_load(file, &width, &height, &nrChannels, 0);
   // now generate texture
-  texture.Generate(width, height, data);
+  texture.Generate(image.Width, image.Height, image.Pixels);
+  object.SetBytes(static_cast<size_t>(image.Width) * image.Height * (image.Alpha ? 4 : 3));
   // and finally free image data
-  stbi_image_free(data);
-  return texture;
-}
\ No newline at end of file
+  if (image.Owned)
+    stbi_image_free(const_cast<unsigned char *>(image.Pixels));
+  image.Pixels = nullptr;
+  image.CacheEntry.reset();
+}
+
+ResourceManager::LevelImage ResourceManager::compileLevel(std::string file)
+{
+  LevelImage image;
+  image.View = nullptr;
+  image.ViewSize = 0;
+  // packed levels are already compiled
+  const AssetPackEntry *entry = Pack.IsOpen() ? Pack.Find(file.c_str()) : nullptr;
+  if (entry && entry->Type == ASSET_LEVEL)
+  {
+    image.View = Pack.Data(*entry);
+    image.ViewSize = entry->Size;
+    return image;
+  }
+
+  std::string path = resolvePath(file.c_str());
+  MappedFile mapped;
+  if (!mapped.Open(path.c_str()))
+  {
+    std::cerr << "ERROR::RESOURCE_MANAGER::LOAD_LEVEL::Failed to read level file: " << path << std::endl;
+    return image;
+  }
+  // compiled levels are copied out of the mapping, text levels compiled
+  if (mapped.Size() >= sizeof(LEVEL_FILE_MAGIC) &&
+      std::memcmp(mapped.Data(), LEVEL_FILE_MAGIC, sizeof(LEVEL_FILE_MAGIC)) == 0)
+  {
+    image.Compiled.assign(mapped.Data(), mapped.Data() + mapped.Size());
+    return image;
+  }
+  LevelTiles tiles;
+  if (ParseLevelText(reinterpret_cast<const char *>(mapped.Data()), mapped.Size(), tiles))
+    CompileLevel(tiles, image.Compiled);
+  return image;
+}
+
+bool ResourceManager::ReloadAsset(const std::string &file, std::vector<std::string> &reloadedShaders)
+{
+  bool used = false;
+  for (std::map<std::string, ShaderFiles>::iterator iter = shaderFiles.begin(); iter != shaderFiles.end(); ++iter)
+  {
+    const ShaderFiles &files = iter->second;
+    if (files.Vertex != file && files.Fragment != file && files.Geometry != file)
+      continue;
+    used = true;
+    std::string vertexCode, fragmentCode, geometryCode;
+    const char *vShaderCode = shaderSource(files.Vertex.c_str(), vertexCode, resolvePath(files.Vertex.c_str()), files.Defines);
+    const char *fShaderCode = shaderSource(files.Fragment.c_str(), fragmentCode, resolvePath(files.Fragment.c_str()), files.Defines);
+    const char *gShaderCode = nullptr;
+    if (!files.Geometry.empty())
+      gShaderCode = shaderSource(files.Geometry.c_str(), geometryCode, resolvePath(files.Geometry.c_str()), files.Defines);
+    // a broken edit keeps the running program
+    Shader &shader = GetShader(iter->first);
+    if (shader.Recompile(vShaderCode, fShaderCode, gShaderCode))
+    {
+      ProgramCache::Store(vShaderCode, fShaderCode, gShaderCode, shader);
+      reloadedShaders.push_back(iter->first);
+    }
+  }
+  for (std::map<std::string, TextureFile>::iterator iter = textureFiles.begin(); iter != textureFiles.end(); ++iter)
+  {
+    if (iter->second.File != file)
+      continue;
+    used = true;
+    TextureImage image = decodeTexture(file, iter->second.Alpha, iter->first);
+    if (!image.Pixels)
+    {
+      std::cout << "ERROR::RESOURCE_MANAGER::RELOAD_ASSET::Failed to decode texture: " << file << std::endl;
+      continue;
+    }
+    // uploaded into the same texture name, so every copy of the texture shows the new image
+    generateTexture(image, GetTexture(iter->first), textureObjects[nameHash(iter->first)]);
+  }
+  // sessions keep playing the old template until they load the level again
+  for (LevelTemplates::iterator iter = levelTemplates.begin(); iter != levelTemplates.end();)
+  {
+    if (std::get<0>(iter->first) == file)
+    {
+      iter = levelTemplates.erase(iter);
+      used = true;
+    }
+    else
+      ++iter;
+  }
+  return used;
+}
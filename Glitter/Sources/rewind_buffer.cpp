@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+
+#include "rewind_buffer.hpp"
+
+// Encoding (native byte order):
+//   keyframe: the snapshot up to DestroyedBricks, the used brick bytes, the used power-ups
+//   delta:    flipped brick count (uint16), their indices (uint16 each), then runs of
+//             changed words { words skipped since the last run, run length (uint8 each),
+//             the words } ended by an empty run { 0, 0 }
+// Words count through the snapshot up to DestroyedBricks and on through PowerUps.
+static const size_t HEADER_BYTES = offsetof(GameSnapshot, DestroyedBricks);
+static const unsigned int HEADER_WORDS = HEADER_BYTES / 4;
+static const unsigned int POWER_UP_WORDS = sizeof(PowerUpSnapshot) / 4;
+static_assert(HEADER_BYTES % 4 == 0 && sizeof(PowerUpSnapshot) % 4 == 0, "snapshot words have to line up");
+static_assert(HEADER_WORDS + SNAPSHOT_MAX_POWER_UPS * POWER_UP_WORDS < 256, "word runs are indexed with a byte");
+
+static size_t wordOffset(unsigned int word)
+{
+  return word < HEADER_WORDS ? word * 4 : offsetof(GameSnapshot, PowerUps) + (word - HEADER_WORDS) * 4;
+}
+
+static void append(std::vector<unsigned char> &data, const void *bytes, size_t size)
+{
+  const unsigned char *begin = static_cast<const unsigned char *>(bytes);
+  data.insert(data.end(), begin, begin + size);
+}
+
+RewindBuffer::RewindBuffer(unsigned int maxTicks, size_t maxBytes, unsigned int keyframeInterval)
+    : maxTicks(maxTicks), maxBytes(maxBytes), keyframeInterval(keyframeInterval), position(0),
+      overflowReported(false)
+{
+  std::memset(&last, 0, sizeof(last));
+  std::memset(&current, 0, sizeof(current));
+}
+
+unsigned int RewindBuffer::First() const
+{
+  return segments.front().FirstTick;
+}
+
+unsigned int RewindBuffer::Last() const
+{
+  return segments.back().FirstTick + static_cast<unsigned int>(segments.back().Offsets.size()) - 1;
+}
+
+size_t RewindBuffer::Bytes() const
+{
+  size_t bytes = spare.Data.capacity() + spare.Offsets.capacity() * sizeof(uint32_t);
+  for (const Segment &segment : segments)
+    bytes += segment.Data.capacity() + segment.Offsets.capacity() * sizeof(uint32_t);
+  return bytes;
+}
+
+void RewindBuffer::Clear()
+{
+  segments.clear();
+  position = 0;
+}
+
+bool RewindBuffer::Push(const Game &game)
+{
+  // every tick would fail alike, e.g. while too many power-ups are falling
+  if (!game.FitsSnapshot())
+  {
+    if (!overflowReported)
+      std::cout << "WARNING::REWIND: States with more than " << SNAPSHOT_MAX_POWER_UPS << " power-ups or "
+                << SNAPSHOT_MAX_BRICKS << " bricks aren't recorded" << std::endl;
+    overflowReported = true;
+    return false;
+  }
+  if (!game.SaveSnapshot(current))
+    return false;
+  // unused power-ups are compared word by word too, so they have to be equally blank
+  std::memset(current.PowerUps + current.PowerUpCount, 0,
+              (SNAPSHOT_MAX_POWER_UPS - current.PowerUpCount) * sizeof(PowerUpSnapshot));
+
+  unsigned int tick = 0;
+  bool keyframe = true;
+  if (!segments.empty())
+  {
+    truncate();
+    tick = position + 1;
+    // bricks of another level can't be diffed against the last ones
+    keyframe = segments.back().Offsets.size() >= keyframeInterval ||
+               current.CurrentLevel != last.CurrentLevel || current.BrickCount != last.BrickCount;
+  }
+  if (keyframe)
+  {
+    segments.push_back(Segment());
+    segments.back().Data.swap(spare.Data);
+    segments.back().Offsets.swap(spare.Offsets);
+    segments.back().Data.clear();
+    segments.back().Offsets.clear();
+    segments.back().FirstTick = tick;
+  }
+  Segment &segment = segments.back();
+  segment.Offsets.push_back(static_cast<uint32_t>(segment.Data.size()));
+  if (keyframe)
+    encodeKeyframe(segment.Data);
+  else
+    encodeDelta(segment.Data);
+  last = current;
+  position = tick;
+  evict();
+  return true;
+}
+
+bool RewindBuffer::Seek(Game &game, unsigned int tick)
+{
+  if (segments.empty() || tick < First() || tick > Last())
+  {
+    std::cout << "ERROR::REWIND: Tick " << tick << " isn't in the history" << std::endl;
+    return false;
+  }
+  // the last segment starting at or before tick
+  std::deque<Segment>::const_iterator segment =
+      std::upper_bound(segments.begin(), segments.end(), tick,
+                       [](unsigned int tick, const Segment &segment)
+                       { return tick < segment.FirstTick; }) - 1;
+  // stepping forward within a segment goes on from the current state, anything else
+  // starts over at the keyframe
+  unsigned int decoded = position;
+  if (tick < position || position < segment->FirstTick)
+  {
+    decodeKeyframe(segment->Data.data());
+    decoded = segment->FirstTick;
+  }
+  for (++decoded; decoded <= tick; ++decoded)
+    decodeDelta(segment->Data.data() + segment->Offsets[decoded - segment->FirstTick]);
+  position = tick;
+  return game.RestoreSnapshot(last);
+}
+
+void RewindBuffer::truncate()
+{
+  // the ticks after position only exist after seeking back
+  while (segments.back().FirstTick > position)
+  {
+    spare.Data.swap(segments.back().Data);
+    spare.Offsets.swap(segments.back().Offsets);
+    segments.pop_back();
+  }
+  Segment &segment = segments.back();
+  size_t kept = position - segment.FirstTick + 1;
+  if (kept < segment.Offsets.size())
+  {
+    segment.Data.resize(segment.Offsets[kept]);
+    segment.Offsets.resize(kept);
+  }
+}
+
+void RewindBuffer::evict()
+{
+  // drop the oldest segment while the rest still covers maxTicks, or while over budget
+  while (segments.size() > 1 &&
+         (Last() - segments[1].FirstTick + 1 >= maxTicks || Bytes() > maxBytes))
+  {
+    spare.Data.swap(segments.front().Data);
+    spare.Offsets.swap(segments.front().Offsets);
+    segments.pop_front();
+  }
+}
+
+void RewindBuffer::encodeKeyframe(std::vector<unsigned char> &data) const
+{
+  append(data, &current, HEADER_BYTES);
+  append(data, current.DestroyedBricks, (current.BrickCount + 7) / 8);
+  append(data, current.PowerUps, current.PowerUpCount * sizeof(PowerUpSnapshot));
+}
+
+void RewindBuffer::decodeKeyframe(const unsigned char *data)
+{
+  std::memset(&last, 0, sizeof(last));
+  std::memcpy(&last, data, HEADER_BYTES);
+  data += HEADER_BYTES;
+  std::memcpy(last.DestroyedBricks, data, (last.BrickCount + 7) / 8);
+  data += (last.BrickCount + 7) / 8;
+  std::memcpy(last.PowerUps, data, last.PowerUpCount * sizeof(PowerUpSnapshot));
+}
+
+void RewindBuffer::encodeDelta(std::vector<unsigned char> &data) const
+{
+  size_t flipsAt = data.size();
+  uint16_t flips = 0;
+  append(data, &flips, sizeof(flips));
+  for (unsigned int i = 0; i < (current.BrickCount + 7) / 8; ++i)
+  {
+    unsigned int changed = current.DestroyedBricks[i] ^ last.DestroyedBricks[i];
+    for (unsigned int bit = 0; changed; ++bit, changed >>= 1)
+    {
+      if (changed & 1)
+      {
+        uint16_t index = static_cast<uint16_t>(i * 8 + bit);
+        append(data, &index, sizeof(index));
+        flips++;
+      }
+    }
+  }
+  std::memcpy(&data[flipsAt], &flips, sizeof(flips));
+
+  const unsigned char *now = reinterpret_cast<const unsigned char *>(&current);
+  const unsigned char *before = reinterpret_cast<const unsigned char *>(&last);
+  unsigned int words = HEADER_WORDS + std::max(current.PowerUpCount, last.PowerUpCount) * POWER_UP_WORDS;
+  unsigned int runEnd = 0;
+  for (unsigned int word = 0; word < words;)
+  {
+    if (std::memcmp(now + wordOffset(word), before + wordOffset(word), 4) == 0)
+    {
+      ++word;
+      continue;
+    }
+    unsigned int start = word;
+    while (word < words && std::memcmp(now + wordOffset(word), before + wordOffset(word), 4) != 0)
+      ++word;
+    data.push_back(static_cast<unsigned char>(start - runEnd));
+    data.push_back(static_cast<unsigned char>(word - start));
+    for (unsigned int i = start; i < word; ++i)
+      append(data, now + wordOffset(i), 4);
+    runEnd = word;
+  }
+  data.push_back(0);
+  data.push_back(0);
+}
+
+void RewindBuffer::decodeDelta(const unsigned char *data)
+{
+  uint16_t flips;
+  std::memcpy(&flips, data, sizeof(flips));
+  data += sizeof(flips);
+  for (uint16_t i = 0; i < flips; ++i, data += sizeof(uint16_t))
+  {
+    uint16_t index;
+    std::memcpy(&index, data, sizeof(index));
+    last.DestroyedBricks[index / 8] ^= static_cast<uint8_t>(1 << (index % 8));
+  }
+
+  unsigned char *state = reinterpret_cast<unsigned char *>(&last);
+  unsigned int runEnd = 0;
+  for (;;)
+  {
+    unsigned int start = runEnd + data[0], count = data[1];
+    data += 2;
+    if (count == 0)
+      return;
+    for (unsigned int word = start; word < start + count; ++word, data += 4)
+      std::memcpy(state + wordOffset(word), data, 4);
+    runEnd = start + count;
+  }
+}
@@ -1,10 +1,12 @@
 #include "shader.hpp"
+#include "render_stats.hpp"
 
 #include <iostream>
 
 Shader &Shader::Use()
 {
   glUseProgram(this->ID);
+  RenderStats::ShaderBinds++;
   return *this;
 }
 
@@ -49,57 +51,117 @@ void Shader::SetFloat(const char *name, float value, bool useShader)
   if (useShader)
     this->Use();
   glUniform1f(glGetUniformLocation(this->ID, name), value);
+  RenderStats::UniformUploads++;
 }
 void Shader::SetInteger(const char *name, int value, bool useShader)
 {
   if (useShader)
     this->Use();
   glUniform1i(glGetUniformLocation(this->ID, name), value);
+  RenderStats::UniformUploads++;
 }
 void Shader::SetVector2f(const char *name, float x, float y, bool useShader)
 {
   if (useShader)
     this->Use();
   glUniform2f(glGetUniformLocation(this->ID, name), x, y);
+  RenderStats::UniformUploads++;
 }
 void Shader::SetVector2f(const char *name, const glm::vec2 &value, bool useShader)
 {
   if (useShader)
     this->Use();
   glUniform2f(glGetUniformLocation(this->ID, name), value.x, value.y);
+  RenderStats::UniformUploads++;
 }
 void Shader::SetVector3f(const char *name, float x, float y, float z, bool useShader)
 {
   if (useShader)
     this->Use();
   glUniform3f(glGetUniformLocation(this->ID, name), x, y, z);
+  RenderStats::UniformUploads++;
 }
 void Shader::SetVector3f(const char *name, const glm::vec3 &value, bool useShader)
 {
   if (useShader)
     this->Use();
   glUniform3f(glGetUniformLocation(this->ID, name), value.x, value.y, value.z);
+  RenderStats::UniformUploads++;
 }
 void Shader::SetVector4f(const char *name, float x, float y, float z, float w, bool useShader)
 {
   if (useShader)
     this->Use();
   glUniform4f(glGetUniformLocation(this->ID, name), x, y, z, w);
+  RenderStats::UniformUploads++;
 }
 void Shader::SetVector4f(const char *name, const glm::vec4 &value, bool useShader)
 {
   if (useShader)
     this->Use();
   glUniform4f(glGetUniformLocation(this->ID, name), value.x, value.y, value.z, value.w);
+  RenderStats::UniformUploads++;
 }
 void Shader::SetMatrix4(const char *name, const glm::mat4 &matrix, bool useShader)
 {
   if (useShader)
     this->Use();
   glUniformMatrix4fv(glGetUniformLocation(this->ID, name), 1, false, glm::value_ptr(matrix));
+  RenderStats::UniformUploads++;
 }
 
-void Shader::checkCompileErrors(unsigned int object, std::string type)
+bool Shader::Recompile(const char *vertexSource, const char *fragmentSource, const char *geometrySource)
+{
+  unsigned int stages[3] = {0, 0, 0};
+  unsigned int count = geometrySource != nullptr ? 3 : 2;
+  stages[0] = compileStage(GL_VERTEX_SHADER, vertexSource, "VERTEX");
+  stages[1] = compileStage(GL_FRAGMENT_SHADER, fragmentSource, "FRAGMENT");
+  if (geometrySource != nullptr)
+    stages[2] = compileStage(GL_GEOMETRY_SHADER, geometrySource, "GEOMETRY");
+  bool compiled = stages[0] && stages[1] && (geometrySource == nullptr || stages[2]);
+
+  // link a scratch program first, the live one is only relinked once the new code is known to link
+  bool linked = false;
+  if (compiled)
+  {
+    unsigned int scratch = glCreateProgram();
+    for (unsigned int i = 0; i < count; ++i)
+      glAttachShader(scratch, stages[i]);
+    glLinkProgram(scratch);
+    linked = checkCompileErrors(scratch, "PROGRAM");
+    glDeleteProgram(scratch);
+  }
+  if (linked)
+  {
+    // swap the attached (old) shaders for the new ones and relink under the same ID
+    int attachedCount = 0;
+    unsigned int attached[3];
+    glGetAttachedShaders(this->ID, 3, &attachedCount, attached);
+    for (int i = 0; i < attachedCount; ++i)
+      glDetachShader(this->ID, attached[i]);
+    for (unsigned int i = 0; i < count; ++i)
+      glAttachShader(this->ID, stages[i]);
+    glLinkProgram(this->ID);
+    linked = checkCompileErrors(this->ID, "PROGRAM");
+  }
+  for (unsigned int i = 0; i < count; ++i)
+    if (stages[i])
+      glDeleteShader(stages[i]);
+  return linked;
+}
+
+unsigned int Shader::compileStage(GLenum stage, const char *source, std::string type)
+{
+  unsigned int shader = glCreateShader(stage);
+  glShaderSource(shader, 1, &source, NULL);
+  glCompileShader(shader);
+  if (checkCompileErrors(shader, type))
+    return shader;
+  glDeleteShader(shader);
+  return 0;
+}
+
+bool Shader::checkCompileErrors(unsigned int object, std::string type)
 {
   int success;
   char infoLog[1024];
@@ -125,4 +187,5 @@ void Shader::checkCompileErrors(unsigned int object, std::string type)
                 << std::endl;
     }
   }
-}
\ No newline at end of file
+  return success != 0;
+}
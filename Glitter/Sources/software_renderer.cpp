@@ -0,0 +1,306 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOFTWARE_RENDERER_SSE2
+#endif
+
+#include "resource_manager.hpp"
+#include "software_renderer.hpp"
+
+// resampled sprites kept before the cache is emptied (at the start of a frame)
+const size_t SPRITE_CACHE_LIMIT = 4096;
+
+SoftwareRenderer::SoftwareRenderer(unsigned int width, unsigned int height, unsigned int sceneWidth,
+                                   unsigned int sceneHeight, unsigned int threads)
+    : width(width), height(height),
+      scaleX(static_cast<float>(width) / sceneWidth), scaleY(static_cast<float>(height) / sceneHeight),
+      tilesX((width + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE),
+      tilesY((height + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE),
+      generation(0), running(0), stopping(false)
+{
+  color.assign(static_cast<size_t>(width) * height * 4, 0);
+  pixels.assign(static_cast<size_t>(width) * height * 3, 0);
+
+  if (threads == 0)
+    threads = std::thread::hardware_concurrency();
+  if (threads > tilesX * tilesY)
+    threads = tilesX * tilesY;
+  for (unsigned int range = 1; range < threads; ++range)
+    workers.push_back(std::thread(&SoftwareRenderer::work, this, range));
+}
+
+SoftwareRenderer::~SoftwareRenderer()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  started.notify_all();
+  for (std::thread &worker : workers)
+    worker.join();
+}
+
+bool SoftwareRenderer::LoadTexture(unsigned int texture, const char *file, bool alpha)
+{
+  std::vector<unsigned char> texels;
+  unsigned int textureWidth, textureHeight;
+  if (!ResourceManager::LoadImage(file, alpha, texels, textureWidth, textureHeight))
+    return false;
+  SetTexture(texture, textureWidth, textureHeight, alpha ? 4 : 3, texels.data());
+  return true;
+}
+
+void SoftwareRenderer::SetTexture(unsigned int texture, unsigned int width, unsigned int height,
+                                  unsigned int channels, const unsigned char *texels)
+{
+  if (texture >= textures.size())
+    textures.resize(texture + 1);
+  Texture &target = textures[texture];
+  target.Width = width;
+  target.Height = height;
+  target.Texels.resize(static_cast<size_t>(width) * height * 4);
+  for (size_t i = 0; i < static_cast<size_t>(width) * height; ++i)
+  {
+    for (unsigned int c = 0; c < 3; ++c)
+      target.Texels[i * 4 + c] = texels[i * channels + c];
+    target.Texels[i * 4 + 3] = channels == 4 ? texels[i * 4 + 3] : 255;
+  }
+  // sprites resampled from the old texels
+  sprites.clear();
+}
+
+void SoftwareRenderer::Begin()
+{
+  quads.clear();
+  if (sprites.size() > SPRITE_CACHE_LIMIT)
+    sprites.clear();
+}
+
+void SoftwareRenderer::DrawSprite(unsigned int texture, glm::vec2 position, glm::vec2 size, glm::vec3 color)
+{
+  Quad quad;
+  if (!cover(position, size, quad))
+    return;
+  quad.Image = &sprite(texture, quad.Right - quad.Left, quad.Bottom - quad.Top, color);
+  quad.Additive = false;
+  quads.push_back(quad);
+}
+
+void SoftwareRenderer::DrawParticle(unsigned int texture, glm::vec2 position, glm::vec2 size, glm::vec4 color)
+{
+  // the shader's color is clamped before blending, so faded particles add nothing
+  float alpha = glm::clamp(color.a, 0.0f, 1.0f);
+  Quad quad;
+  unsigned int scale = 0;
+  for (unsigned int c = 0; c < 3; ++c)
+  {
+    quad.Scale[c] = static_cast<uint16_t>(glm::clamp(color[c], 0.0f, 1.0f) * alpha * 256.0f + 0.5f);
+    scale |= quad.Scale[c];
+  }
+  if (scale == 0 || !cover(position, size, quad))
+    return;
+  quad.Image = &sprite(texture, quad.Right - quad.Left, quad.Bottom - quad.Top, glm::vec3(1.0f));
+  quad.Additive = true;
+  quads.push_back(quad);
+}
+
+void SoftwareRenderer::Finish()
+{
+  if (!workers.empty())
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    running = static_cast<unsigned int>(workers.size());
+    generation++;
+  }
+  started.notify_all();
+  drawRange(0);
+
+  std::unique_lock<std::mutex> lock(mutex);
+  while (running > 0)
+    finished.wait(lock);
+}
+
+void SoftwareRenderer::work(unsigned int range)
+{
+  unsigned int seen = 0;
+  for (;;)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (!stopping && generation == seen)
+        started.wait(lock);
+      if (stopping)
+        return;
+      seen = generation;
+    }
+    drawRange(range);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (--running == 0)
+      finished.notify_one();
+  }
+}
+
+void SoftwareRenderer::drawRange(unsigned int range)
+{
+  unsigned int ranges = static_cast<unsigned int>(workers.size()) + 1;
+  unsigned int tiles = tilesX * tilesY;
+  for (unsigned int tile = tiles * range / ranges; tile < tiles * (range + 1) / ranges; ++tile)
+    drawTile(tile);
+}
+
+// premultiplied alpha blending of count pixels, dst = src + dst * (255 - src alpha) / 255
+static void blendRow(uint8_t *dst, const uint8_t *src, int count)
+{
+  int i = 0;
+#ifdef SOFTWARE_RENDERER_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i half = _mm_set1_epi16(128);
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i * 4));
+    // 255 - alpha of each pixel, in all four of its bytes
+    __m128i alpha = _mm_srli_epi32(s, 24);
+    alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 8));
+    alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+    __m128i inverse = _mm_xor_si128(alpha, _mm_set1_epi8(-1));
+    // x / 255 as (x + 128 + ((x + 128) >> 8)) >> 8, exact for x up to 255 * 255
+    __m128i low = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(inverse, zero)), half);
+    __m128i high = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(inverse, zero)), half);
+    low = _mm_srli_epi16(_mm_add_epi16(low, _mm_srli_epi16(low, 8)), 8);
+    high = _mm_srli_epi16(_mm_add_epi16(high, _mm_srli_epi16(high, 8)), 8);
+    d = _mm_adds_epu8(s, _mm_packus_epi16(low, high));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), d);
+  }
+#endif
+  for (; i < count; ++i)
+  {
+    unsigned int inverse = 255 - src[i * 4 + 3];
+    for (unsigned int c = 0; c < 4; ++c)
+    {
+      unsigned int x = dst[i * 4 + c] * inverse + 128;
+      dst[i * 4 + c] = static_cast<uint8_t>(std::min(255u, src[i * 4 + c] + ((x + (x >> 8)) >> 8)));
+    }
+  }
+}
+
+// additive blending of count pixels scaled by scale / 256 per channel, saturating
+static void addRow(uint8_t *dst, const uint8_t *src, int count, const uint16_t *scale)
+{
+  for (int i = 0; i < count; ++i)
+  {
+    for (unsigned int c = 0; c < 3; ++c)
+      dst[i * 4 + c] = static_cast<uint8_t>(
+          std::min(255u, dst[i * 4 + c] + (static_cast<unsigned int>(src[i * 4 + c]) * scale[c] >> 8)));
+  }
+}
+
+void SoftwareRenderer::drawTile(unsigned int tile)
+{
+  int left = static_cast<int>(tile % tilesX * SOFTWARE_TILE_SIZE);
+  int top = static_cast<int>(tile / tilesX * SOFTWARE_TILE_SIZE);
+  int right = std::min(left + static_cast<int>(SOFTWARE_TILE_SIZE), static_cast<int>(width));
+  int bottom = std::min(top + static_cast<int>(SOFTWARE_TILE_SIZE), static_cast<int>(height));
+  size_t stride = static_cast<size_t>(width) * 4;
+  for (int y = top; y < bottom; ++y)
+    std::memset(&color[y * stride + left * 4], 0, (right - left) * 4);
+
+  // quads in the order they were drawn, each clipped to the tile
+  for (const Quad &quad : quads)
+  {
+    int x0 = std::max(quad.Left, left), x1 = std::min(quad.Right, right);
+    int y0 = std::max(quad.Top, top), y1 = std::min(quad.Bottom, bottom);
+    if (x0 >= x1 || y0 >= y1)
+      continue;
+    const Sprite &image = *quad.Image;
+    for (int y = y0; y < y1; ++y)
+    {
+      uint8_t *dst = &color[y * stride + x0 * 4];
+      const uint8_t *src = &image.Texels[(static_cast<size_t>(y - quad.Top) * image.Width + (x0 - quad.Left)) * 4];
+      if (quad.Additive)
+        addRow(dst, src, x1 - x0, quad.Scale);
+      else if (image.Opaque)
+        std::memcpy(dst, src, (x1 - x0) * 4);
+      else
+        blendRow(dst, src, x1 - x0);
+    }
+  }
+
+  for (int y = top; y < bottom; ++y)
+  {
+    const uint8_t *src = &color[y * stride + left * 4];
+    uint8_t *dst = &pixels[(static_cast<size_t>(y) * width + left) * 3];
+    for (int x = 0; x < right - left; ++x)
+    {
+      dst[x * 3] = src[x * 4];
+      dst[x * 3 + 1] = src[x * 4 + 1];
+      dst[x * 3 + 2] = src[x * 4 + 2];
+    }
+  }
+}
+
+const SoftwareRenderer::Sprite &SoftwareRenderer::sprite(unsigned int texture, int width, int height, glm::vec3 color)
+{
+  // the tint is applied in 8 bits, so colors that look the same share a sprite
+  unsigned int tint[3];
+  for (unsigned int c = 0; c < 3; ++c)
+    tint[c] = static_cast<unsigned int>(glm::clamp(color[c], 0.0f, 1.0f) * 255.0f + 0.5f);
+  uint64_t key = static_cast<uint64_t>(texture & 0xFF) << 56 | static_cast<uint64_t>(width & 0xFFFF) << 40 |
+                 static_cast<uint64_t>(height & 0xFFFF) << 24 | tint[0] << 16 | tint[1] << 8 | tint[2];
+  std::unordered_map<uint64_t, Sprite>::iterator found = sprites.find(key);
+  if (found != sprites.end())
+    return found->second;
+
+  Sprite &image = sprites[key];
+  image.Width = width;
+  image.Height = height;
+  image.Opaque = true;
+  image.Texels.assign(static_cast<size_t>(width) * height * 4, 0);
+  if (texture >= textures.size() || textures[texture].Texels.empty())
+    return image;
+  // every pixel averages the texels it covers (the nearest one when magnifying),
+  // premultiplied by their alpha
+  const Texture &source = textures[texture];
+  for (int y = 0; y < height; ++y)
+  {
+    unsigned int sy0 = static_cast<unsigned int>(static_cast<uint64_t>(y) * source.Height / height);
+    unsigned int sy1 = std::max(sy0 + 1, static_cast<unsigned int>(static_cast<uint64_t>(y + 1) * source.Height / height));
+    for (int x = 0; x < width; ++x)
+    {
+      unsigned int sx0 = static_cast<unsigned int>(static_cast<uint64_t>(x) * source.Width / width);
+      unsigned int sx1 = std::max(sx0 + 1, static_cast<unsigned int>(static_cast<uint64_t>(x + 1) * source.Width / width));
+      unsigned long long sum[4] = {0, 0, 0, 0};
+      for (unsigned int sy = sy0; sy < sy1; ++sy)
+      {
+        const uint8_t *texel = &source.Texels[(static_cast<size_t>(sy) * source.Width + sx0) * 4];
+        for (unsigned int sx = sx0; sx < sx1; ++sx, texel += 4)
+        {
+          for (unsigned int c = 0; c < 3; ++c)
+            sum[c] += texel[c] * texel[3];
+          sum[3] += texel[3];
+        }
+      }
+      unsigned long long texels = static_cast<unsigned long long>(sy1 - sy0) * (sx1 - sx0);
+      uint8_t *pixel = &image.Texels[(static_cast<size_t>(y) * width + x) * 4];
+      for (unsigned int c = 0; c < 3; ++c)
+        pixel[c] = static_cast<uint8_t>((sum[c] * tint[c] + texels * 255 * 255 / 2) / (texels * 255 * 255));
+      pixel[3] = static_cast<uint8_t>((sum[3] + texels / 2) / texels);
+      image.Opaque = image.Opaque && pixel[3] == 255;
+    }
+  }
+  return image;
+}
+
+bool SoftwareRenderer::cover(glm::vec2 position, glm::vec2 size, Quad &quad) const
+{
+  // the first and one past the last pixel whose center is inside, on each axis
+  quad.Left = static_cast<int>(std::ceil(position.x * scaleX - 0.5f));
+  quad.Right = static_cast<int>(std::ceil((position.x + size.x) * scaleX - 0.5f));
+  quad.Top = static_cast<int>(std::ceil(position.y * scaleY - 0.5f));
+  quad.Bottom = static_cast<int>(std::ceil((position.y + size.y) * scaleY - 0.5f));
+  return quad.Left < quad.Right && quad.Top < quad.Bottom && quad.Right > 0 && quad.Bottom > 0 &&
+         quad.Left < static_cast<int>(width) && quad.Top < static_cast<int>(height);
+}
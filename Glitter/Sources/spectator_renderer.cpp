@@ -0,0 +1,260 @@
+#include <algorithm>
+#include <cmath>
+
+#include "render_stats.hpp"
+#include "spectator_renderer.hpp"
+
+SpectatorRenderer::SpectatorRenderer(Shader shader, unsigned int width, unsigned int height,
+                                     unsigned int sceneWidth, unsigned int sceneHeight)
+    : DetailWidth(200.0f), shader(shader), width(width), height(height),
+      sceneSize(static_cast<float>(sceneWidth), static_cast<float>(sceneHeight)), tileSize(0.0f), columns(0)
+{
+  this->shader.Use();
+  this->shader.SetInteger("spriteTexture", 0);
+  this->shader.SetMatrix4("projection", glm::ortho(0.0f, static_cast<float>(width),
+                                                   static_cast<float>(height), 0.0f, -1.0f, 1.0f));
+  initRenderData();
+  SetLayout(1);
+}
+
+void SpectatorRenderer::SetLayout(unsigned int sessions)
+{
+  // the column count that gives the largest tiles, in whole pixels so tiles don't overlap
+  float aspect = sceneSize.x / sceneSize.y;
+  float best = 0.0f;
+  for (unsigned int candidate = 1; candidate <= std::max(sessions, 1u); ++candidate)
+  {
+    unsigned int rows = (sessions + candidate - 1) / candidate;
+    float tileWidth = std::floor(std::min(static_cast<float>(width) / candidate,
+                                          static_cast<float>(height) / std::max(rows, 1u) * aspect));
+    if (tileWidth > best)
+    {
+      best = tileWidth;
+      columns = candidate;
+    }
+  }
+  tileSize = glm::vec2(best, std::floor(best / aspect));
+
+  // the grid is centered on the wall
+  unsigned int rows = (sessions + columns - 1) / columns;
+  glm::vec2 corner(std::floor((width - tileSize.x * columns) * 0.5f), std::floor((height - tileSize.y * rows) * 0.5f));
+  tiles.resize(sessions);
+  for (unsigned int tile = 0; tile < sessions; ++tile)
+  {
+    tiles[tile].Origin = corner + tileSize * glm::vec2(static_cast<float>(tile % columns), static_cast<float>(tile / columns));
+    tiles[tile].Offset = glm::vec2(0.0f);
+    tiles[tile].Flip = tiles[tile].Invert = false;
+  }
+}
+
+void SpectatorRenderer::SetTexture(unsigned int texture, const Texture2D &image)
+{
+  if (texture >= textures.size())
+    textures.resize(texture + 1);
+  textures[texture] = image;
+}
+
+void SpectatorRenderer::Begin()
+{
+  for (unsigned int batch : order)
+  {
+    batches[batch].Instances.clear();
+    batches[batch].Used = false;
+  }
+  order.clear();
+  for (Tile &tile : tiles)
+  {
+    tile.Offset = glm::vec2(0.0f);
+    tile.Flip = tile.Invert = false;
+  }
+}
+
+void SpectatorRenderer::SetEffects(unsigned int tile, bool confuse, bool shake, float time)
+{
+  if (!Detailed())
+    return;
+  Tile &target = tiles[tile];
+  target.Flip = target.Invert = confuse;
+  // the post-processing shader's shake, scaled from the screen to the tile
+  if (shake)
+    target.Offset = glm::vec2(std::cos(time * 10.0f), -std::cos(time * 15.0f)) * 0.005f * tileSize;
+}
+
+void SpectatorRenderer::DrawSprite(unsigned int tile, unsigned int texture, glm::vec2 position, glm::vec2 size,
+                                   glm::vec3 color)
+{
+  add(tile, texture * 2, position, size, glm::vec4(color, 1.0f));
+}
+
+void SpectatorRenderer::DrawParticle(unsigned int tile, unsigned int texture, glm::vec2 position, glm::vec2 size,
+                                     glm::vec4 color)
+{
+  if (Detailed())
+    add(tile, texture * 2 + 1, position, size, color);
+}
+
+void SpectatorRenderer::add(unsigned int tile, unsigned int batch, glm::vec2 position, glm::vec2 size, glm::vec4 color)
+{
+  // clipped to the scene, so nothing spills into the neighbouring tiles
+  glm::vec2 first = glm::max(position, glm::vec2(0.0f));
+  glm::vec2 last = glm::min(position + size, sceneSize);
+  if (first.x >= last.x || first.y >= last.y)
+    return;
+  glm::vec2 firstTexel = (first - position) / size;
+  glm::vec2 lastTexel = (last - position) / size;
+  const Tile &target = tiles[tile];
+  if (target.Flip)
+  {
+    // turned upside down: the rectangle is mirrored within the scene and its texture
+    // coordinates run backwards
+    glm::vec2 mirrored = sceneSize - last;
+    last = sceneSize - first;
+    first = mirrored;
+    std::swap(firstTexel, lastTexel);
+  }
+  glm::vec2 scale = tileSize / sceneSize;
+
+  if (batch >= batches.size())
+    batches.resize(batch + 1);
+  Batch &instances = batches[batch];
+  if (!instances.Used)
+  {
+    instances.Used = true;
+    order.push_back(batch);
+  }
+  Instance instance;
+  glm::vec2 corner = target.Origin + target.Offset + first * scale;
+  glm::vec2 extent = (last - first) * scale;
+  instance.Rect = glm::vec4(corner.x, corner.y, extent.x, extent.y);
+  instance.TexRect = glm::vec4(firstTexel.x, firstTexel.y, lastTexel.x, lastTexel.y);
+  instance.Color = color;
+  instances.Instances.push_back(instance);
+}
+
+void SpectatorRenderer::Finish()
+{
+  // every batch's instances, then a white quad per inverted tile
+  uploaded.clear();
+  firsts.clear();
+  for (unsigned int batch : order)
+  {
+    firsts.push_back(uploaded.size());
+    uploaded.insert(uploaded.end(), batches[batch].Instances.begin(), batches[batch].Instances.end());
+  }
+  size_t inverts = uploaded.size();
+  for (const Tile &tile : tiles)
+  {
+    if (!tile.Invert)
+      continue;
+    Instance instance;
+    glm::vec2 corner = tile.Origin + tile.Offset;
+    instance.Rect = glm::vec4(corner.x, corner.y, tileSize.x, tileSize.y);
+    instance.TexRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+    instance.Color = glm::vec4(1.0f);
+    uploaded.push_back(instance);
+  }
+  if (uploaded.empty())
+    return;
+
+  glBindBuffer(GL_ARRAY_BUFFER, instanceVBO.ID());
+  glBufferData(GL_ARRAY_BUFFER, uploaded.size() * sizeof(Instance), uploaded.data(), GL_STREAM_DRAW);
+  instanceVBO.SetBytes(uploaded.size() * sizeof(Instance));
+  shader.Use();
+  glActiveTexture(GL_TEXTURE0);
+  glBindVertexArray(quadVAO.ID());
+  RenderStats::VertexArrayBinds++;
+
+  // blending stays as SpriteRenderer expects it unless changed (restored at the end)
+  bool additive = false, blendChanged = false;
+  for (size_t i = 0; i < order.size(); ++i)
+  {
+    if (((order[i] & 1) != 0) != additive)
+    {
+      additive = !additive;
+      glBlendFunc(GL_SRC_ALPHA, additive ? GL_ONE : GL_ONE_MINUS_SRC_ALPHA);
+      RenderStats::BlendChanges++;
+      blendChanged = true;
+    }
+    unsigned int texture = order[i] / 2;
+    if (texture < textures.size())
+      textures[texture].Bind();
+    else
+      Texture2D().Bind();
+    bindInstances(firsts[i]);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, static_cast<GLsizei>(batches[order[i]].Instances.size()));
+    RenderStats::DrawCalls++;
+  }
+  if (uploaded.size() > inverts)
+  {
+    // white times one minus what's there: the tile's colors inverted, like confuse
+    glBlendFunc(GL_ONE_MINUS_DST_COLOR, GL_ZERO);
+    RenderStats::BlendChanges++;
+    blendChanged = true;
+    white.Bind();
+    bindInstances(inverts);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, static_cast<GLsizei>(uploaded.size() - inverts));
+    RenderStats::DrawCalls++;
+  }
+  if (blendChanged)
+  {
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    RenderStats::BlendChanges++;
+  }
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  RenderStats::VertexArrayBinds++;
+}
+
+void SpectatorRenderer::bindInstances(size_t first)
+{
+  // GL 3.3 has no base instance, so the attributes are pointed at the batch's first instance
+  for (unsigned int attribute = 0; attribute < 3; ++attribute)
+    glVertexAttribPointer(1 + attribute, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                          (void *)(first * sizeof(Instance) + attribute * sizeof(glm::vec4)));
+}
+
+void SpectatorRenderer::initRenderData()
+{
+  // unit quad, the instances place and size it
+  float vertices[] = {
+      // pos      // tex
+      0.0f, 1.0f, 0.0f, 1.0f,
+      1.0f, 0.0f, 1.0f, 0.0f,
+      0.0f, 0.0f, 0.0f, 0.0f,
+
+      0.0f, 1.0f, 0.0f, 1.0f,
+      1.0f, 1.0f, 1.0f, 1.0f,
+      1.0f, 0.0f, 1.0f, 0.0f};
+
+  quadVAO = GLObject(GL_OBJECT_VERTEX_ARRAY, "spectator");
+  quadVBO = GLObject(GL_OBJECT_BUFFER, "spectator");
+  instanceVBO = GLObject(GL_OBJECT_BUFFER, "spectator");
+
+  glBindVertexArray(quadVAO.ID());
+  glBindBuffer(GL_ARRAY_BUFFER, quadVBO.ID());
+  glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+  quadVBO.SetBytes(sizeof(vertices));
+  glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)0);
+  glEnableVertexAttribArray(0);
+
+  // rectangle, texture rectangle and color, advancing once per instance
+  glBindBuffer(GL_ARRAY_BUFFER, instanceVBO.ID());
+  for (unsigned int attribute = 1; attribute <= 3; ++attribute)
+  {
+    glEnableVertexAttribArray(attribute);
+    glVertexAttribDivisor(attribute, 1);
+  }
+  bindInstances(0);
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+
+  // the quad inverted tiles are covered with
+  whiteTexture = GLObject(GL_OBJECT_TEXTURE, "spectator");
+  white.ID = whiteTexture.ID();
+  white.Internal_Format = GL_RGBA;
+  white.Image_Format = GL_RGBA;
+  const unsigned char texel[4] = {255, 255, 255, 255};
+  white.Generate(1, 1, texel);
+  whiteTexture.SetBytes(sizeof(texel));
+}
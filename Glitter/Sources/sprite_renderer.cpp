@@ -1,19 +1,15 @@
 #include "sprite_renderer.hpp"
+#include "render_stats.hpp"
 
-// Constructor and Destructor
+// Constructor
 SpriteRenderer::SpriteRenderer(Shader &shader)
     : shader(shader)
 {
   this->initRenderData();
 }
 
-SpriteRenderer::~SpriteRenderer()
-{
-  glDeleteVertexArrays(1, &this->quadVAO);
-}
-
-void SpriteRenderer::DrawSprite(Texture2D &texture, glm::vec2 position,
-                                glm::vec2 size, float rotate, glm::vec3 color)
+void SpriteRenderer::DrawSprite(const Texture2D &texture, glm::vec2 position,
+                                      glm::vec2 size, float rotate, glm::vec3 color)
 {
   // Prepare transformations
   this->shader.Use();
@@ -31,15 +27,16 @@ void SpriteRenderer::DrawSprite(Texture2D &texture, glm::vec2 position,
   glActiveTexture(GL_TEXTURE0);
   texture.Bind();
 
-  glBindVertexArray(this->quadVAO);
+  glBindVertexArray(this->quadVAO.ID());
   glDrawArrays(GL_TRIANGLES, 0, 6);
   glBindVertexArray(0);
+  RenderStats::VertexArrayBinds += 2;
+  RenderStats::DrawCalls++;
 }
 
 void SpriteRenderer::initRenderData()
 {
   // Configure VAO/VBO for sprite rendering
-  unsigned int VBO;
   float vertices[] = {
       // pos      // tex
       0.0f, 1.0f, 0.0f, 1.0f,
@@ -50,13 +47,14 @@ void SpriteRenderer::initRenderData()
       1.0f, 1.0f, 1.0f, 1.0f,
       1.0f, 0.0f, 1.0f, 0.0f};
 
-  glGenVertexArrays(1, &this->quadVAO);
-  glGenBuffers(1, &VBO);
+  this->quadVAO = GLObject(GL_OBJECT_VERTEX_ARRAY, "sprites");
+  this->quadVBO = GLObject(GL_OBJECT_BUFFER, "sprites");
 
-  glBindVertexArray(this->quadVAO);
+  glBindVertexArray(this->quadVAO.ID());
 
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
+  glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO.ID());
   glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+  this->quadVBO.SetBytes(sizeof(vertices));
 
   // Position + texture attributes
   glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)0);
@@ -0,0 +1,37 @@
+#include <iomanip>
+#include <iostream>
+
+#include "startup_timeline.hpp"
+
+// Instantiate static variables
+std::chrono::steady_clock::time_point StartupTimeline::start = std::chrono::steady_clock::now();
+std::vector<std::pair<std::string, double>> StartupTimeline::milestones;
+
+void StartupTimeline::Begin()
+{
+  start = std::chrono::steady_clock::now();
+  milestones.clear();
+}
+
+void StartupTimeline::Mark(const char *milestone)
+{
+  double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  milestones.push_back(std::make_pair(std::string(milestone), ms));
+}
+
+void StartupTimeline::Print()
+{
+  std::ios::fmtflags flags = std::cout.flags();
+  std::streamsize precision = std::cout.precision();
+  std::cout << "startup timeline:" << std::endl;
+  double previous = 0.0;
+  for (const std::pair<std::string, double> &milestone : milestones)
+  {
+    std::cout << "  " << std::left << std::setw(24) << milestone.first << std::right
+              << std::fixed << std::setprecision(2) << std::setw(9) << milestone.second << " ms  (+"
+              << milestone.second - previous << ")" << std::endl;
+    previous = milestone.second;
+  }
+  std::cout.flags(flags);
+  std::cout.precision(precision);
+}
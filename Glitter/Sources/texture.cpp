@@ -1,14 +1,14 @@
 #include <iostream>
 
 #include "texture.hpp"
+#include "render_stats.hpp"
 
 Texture2D::Texture2D()
-    : Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB), Wrap_S(GL_REPEAT), Wrap_T(GL_REPEAT), Filter_Min(GL_LINEAR), Filter_Max(GL_LINEAR)
+    : ID(0), Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB), Wrap_S(GL_REPEAT), Wrap_T(GL_REPEAT), Filter_Min(GL_LINEAR), Filter_Max(GL_LINEAR)
 {
-  glGenTextures(1, &this->ID);
 }
 
-void Texture2D::Generate(unsigned int width, unsigned int height, unsigned char *data)
+void Texture2D::Generate(unsigned int width, unsigned int height, const unsigned char *data)
 {
   this->Width = width;
   this->Height = height;
@@ -27,4 +27,5 @@ void Texture2D::Generate(unsigned int width, unsigned int height, unsigned char
 void Texture2D::Bind() const
 {
   glBindTexture(GL_TEXTURE_2D, this->ID);
+  RenderStats::TextureBinds++;
 }
\ No newline at end of file
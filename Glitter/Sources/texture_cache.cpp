@@ -0,0 +1,155 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#include "hash.hpp"
+#include "texture_cache.hpp"
+
+// Instantiate static variables
+std::string TextureCache::Directory;
+
+// size and modification time of a file, false if it doesn't exist
+static bool sourceInfo(const std::string &file, uint64_t &size, int64_t &modified)
+{
+  struct stat info;
+  if (stat(file.c_str(), &info) != 0)
+    return false;
+  size = static_cast<uint64_t>(info.st_size);
+  modified = static_cast<int64_t>(info.st_mtime);
+  return true;
+}
+
+// FNV-1a hash of a file's contents
+static bool sourceHash(const std::string &file, uint64_t &hash)
+{
+  MappedFile source;
+  if (!source.Open(file.c_str()))
+    return false;
+  unsigned long long contentHash = HASH_OFFSET_BASIS;
+  HashBytes(contentHash, source.Data(), source.Size());
+  hash = contentHash;
+  return true;
+}
+
+bool TextureCache::Enable(const std::string &directory)
+{
+#ifdef _WIN32
+  _mkdir(directory.c_str());
+#else
+  mkdir(directory.c_str(), 0755);
+#endif
+  struct stat info;
+  if (stat(directory.c_str(), &info) != 0 || !(info.st_mode & S_IFDIR))
+  {
+    std::cout << "ERROR::TEXTURE_CACHE::ENABLE::Failed to create cache directory: " << directory << std::endl;
+    Directory.clear();
+    return false;
+  }
+  Directory = directory;
+  return true;
+}
+
+const TextureCacheHeader *TextureCache::Load(const std::string &source, MappedFile &entry)
+{
+  uint64_t size;
+  int64_t modified;
+  if (Directory.empty() || !sourceInfo(source, size, modified))
+    return nullptr;
+  std::string path = entryPath(source);
+  if (!entry.Open(path.c_str()))
+    return nullptr;
+
+  const TextureCacheHeader *header = reinterpret_cast<const TextureCacheHeader *>(entry.Data());
+  if (entry.Size() < sizeof(TextureCacheHeader) ||
+      std::memcmp(header->Magic, TEXTURE_CACHE_MAGIC, sizeof(TEXTURE_CACHE_MAGIC)) != 0 ||
+      header->Version != TEXTURE_CACHE_VERSION ||
+      entry.Size() < sizeof(TextureCacheHeader) + static_cast<uint64_t>(header->Width) * header->Height * header->Channels ||
+      header->SourceSize != size)
+  {
+    entry.Close();
+    return nullptr;
+  }
+  if (header->SourceModified == modified)
+    return header;
+
+  // touched but maybe not changed (e.g. a fresh checkout), compare the contents
+  uint64_t hash;
+  if (!sourceHash(source, hash) || hash != header->SourceHash)
+  {
+    entry.Close();
+    return nullptr;
+  }
+  // remember the new modification time so the next launch skips the hash
+  TextureCacheHeader updated = *header;
+  updated.SourceModified = modified;
+  entry.Close();
+  std::fstream file(path.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+  file.write(reinterpret_cast<const char *>(&updated), sizeof(updated));
+  file.close();
+  if (!entry.Open(path.c_str()))
+    return nullptr;
+  return reinterpret_cast<const TextureCacheHeader *>(entry.Data());
+}
+
+bool TextureCache::Store(const std::string &source, unsigned int width, unsigned int height,
+                         unsigned int channels, const unsigned char *texels)
+{
+  if (Directory.empty() || !texels)
+    return false;
+  TextureCacheHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.Magic, TEXTURE_CACHE_MAGIC, sizeof(header.Magic));
+  header.Version = TEXTURE_CACHE_VERSION;
+  header.Width = width;
+  header.Height = height;
+  header.Channels = channels;
+  if (!sourceInfo(source, header.SourceSize, header.SourceModified) ||
+      !sourceHash(source, header.SourceHash))
+    return false;
+
+  // write to a temporary file of this process first so a concurrent launch never maps
+  // a partial entry, and two launches storing the same entry don't share a file
+  std::string path = entryPath(source);
+  std::ostringstream temporaryName;
+  temporaryName << path << "." << getpid() << ".tmp";
+  std::string temporary = temporaryName.str();
+  std::ofstream file(temporary.c_str(), std::ios::binary);
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char *>(texels), static_cast<size_t>(width) * height * channels);
+  file.close();
+  if (!file)
+  {
+    std::cout << "ERROR::TEXTURE_CACHE::STORE::Failed to write cache entry: " << temporary << std::endl;
+    std::remove(temporary.c_str());
+    return false;
+  }
+#ifdef _WIN32
+  std::remove(path.c_str());
+#endif
+  if (std::rename(temporary.c_str(), path.c_str()) != 0)
+  {
+    std::remove(temporary.c_str());
+    return false;
+  }
+  return true;
+}
+
+std::string TextureCache::entryPath(const std::string &source)
+{
+  unsigned long long hash = HASH_OFFSET_BASIS;
+  HashBytes(hash, source.data(), source.size());
+  std::ostringstream path;
+  path << Directory << "/" << std::hex << hash << ".btex";
+  return path.str();
+}
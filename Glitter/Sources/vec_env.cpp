@@ -0,0 +1,190 @@
+#include <cstring>
+#include <iostream>
+
+#include "vec_env.hpp"
+
+VecEnv::VecEnv(unsigned int sessions, unsigned int level, unsigned int seed, unsigned int threads, float dt)
+    : BrickReward(1.0f), BallLostPenalty(10.0f), seed(seed), dt(dt), brickBytes(0),
+      generation(0), running(0), stopping(false), actions(nullptr)
+{
+  for (unsigned int i = 0; i < sessions; ++i)
+  {
+    games.push_back(std::unique_ptr<Game>(new Game(SCREEN_WIDTH, SCREEN_HEIGHT)));
+    games.back()->InitHeadless();
+    games.back()->CurrentLevel = level;
+    games.back()->UpdateParticles = false;
+  }
+  if (!games.empty() && level >= games[0]->Levels.size())
+  {
+    std::cout << "ERROR::VEC_ENV: No level " << level << ", the game has " << games[0]->Levels.size() << " levels"
+              << std::endl;
+    games.clear();
+  }
+  // every session shares the level's template, so their starting states only differ in the seed
+  if (!games.empty())
+  {
+    games[0]->SaveSnapshot(start);
+    brickBytes = static_cast<unsigned int>(games[0]->Levels[level].Destroyed.size());
+  }
+  episodes.assign(sessions, 0);
+  observations.assign(static_cast<size_t>(sessions) * OBS_FLOATS, 0.0f);
+  bricks.assign(static_cast<size_t>(sessions) * brickBytes, 0);
+  rewards.assign(sessions, 0.0f);
+  dones.assign(sessions, 0);
+  Reset();
+
+  if (threads == 0)
+    threads = std::thread::hardware_concurrency();
+  if (threads > sessions)
+    threads = sessions;
+  for (unsigned int range = 1; range < threads; ++range)
+    workers.push_back(std::thread(&VecEnv::work, this, range));
+}
+
+VecEnv::~VecEnv()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  started.notify_all();
+  for (std::thread &worker : workers)
+    worker.join();
+}
+
+void VecEnv::SetParticles(bool particles)
+{
+  for (std::unique_ptr<Game> &game : games)
+    game->UpdateParticles = particles;
+}
+
+void VecEnv::Reset()
+{
+  for (unsigned int session = 0; session < games.size(); ++session)
+  {
+    episodes[session] = 0;
+    resetSession(session);
+    observe(session);
+  }
+}
+
+void VecEnv::Step(const uint8_t *actions)
+{
+  if (!workers.empty())
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->actions = actions;
+    running = static_cast<unsigned int>(workers.size());
+    generation++;
+  }
+  else
+    this->actions = actions;
+  started.notify_all();
+  stepRange(0);
+
+  std::unique_lock<std::mutex> lock(mutex);
+  while (running > 0)
+    finished.wait(lock);
+}
+
+void VecEnv::work(unsigned int range)
+{
+  unsigned int seen = 0;
+  for (;;)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (!stopping && generation == seen)
+        started.wait(lock);
+      if (stopping)
+        return;
+      seen = generation;
+    }
+    stepRange(range);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (--running == 0)
+      finished.notify_one();
+  }
+}
+
+// counts the set bits of a brick bitset
+static unsigned int countBits(const uint8_t *bits, size_t size)
+{
+  unsigned int count = 0;
+  for (size_t i = 0; i < size; ++i)
+  {
+    for (unsigned int byte = bits[i]; byte; byte &= byte - 1)
+      count++;
+  }
+  return count;
+}
+
+void VecEnv::stepRange(unsigned int range)
+{
+  unsigned int ranges = static_cast<unsigned int>(workers.size()) + 1;
+  size_t first = games.size() * range / ranges, last = games.size() * (range + 1) / ranges;
+  for (size_t session = first; session < last; ++session)
+  {
+    Game &game = *games[session];
+    // the same keys Replay::Apply sets, so a policy plays like a recorded player
+    uint8_t action = actions[session];
+    game.Keys[GLFW_KEY_LEFT] = action == ACTION_LEFT;
+    game.Keys[GLFW_KEY_RIGHT] = action == ACTION_RIGHT;
+    game.Keys[GLFW_KEY_SPACE] = action == ACTION_LAUNCH;
+
+    const GameLevel &level = game.Levels[game.CurrentLevel];
+    unsigned int destroyed = countBits(level.Destroyed.data(), level.Destroyed.size());
+    unsigned int ballsLost = game.BallsLost;
+    game.ProcessInput(dt);
+    game.Update(dt);
+
+    bool lost = game.BallsLost != ballsLost;
+    // a lost ball already brought the bricks back
+    if (lost)
+      rewards[session] = -BallLostPenalty;
+    else
+      rewards[session] = BrickReward * (countBits(level.Destroyed.data(), level.Destroyed.size()) - destroyed);
+    dones[session] = lost || level.IsCompleted();
+    if (dones[session])
+    {
+      episodes[session]++;
+      resetSession(static_cast<unsigned int>(session));
+    }
+    observe(static_cast<unsigned int>(session));
+  }
+}
+
+void VecEnv::resetSession(unsigned int session)
+{
+  Game &game = *games[session];
+  game.RestoreSnapshot(start);
+  // sessions and their episodes each spawn their own power-ups
+  game.SetSeed(seed + session * 0x9E3779B9u + episodes[session] * 0x85EBCA6Bu);
+}
+
+void VecEnv::observe(unsigned int session)
+{
+  const Game &game = *games[session];
+  float *observation = &observations[static_cast<size_t>(session) * OBS_FLOATS];
+  const GameObject &player = game.GetPlayer();
+  const BallObject &ball = game.GetBall();
+  observation[OBS_PADDLE_X] = player.Position.x;
+  observation[OBS_PADDLE_WIDTH] = player.Size.x;
+  observation[OBS_BALL_X] = ball.Position.x;
+  observation[OBS_BALL_Y] = ball.Position.y;
+  observation[OBS_BALL_RADIUS] = ball.Radius;
+  observation[OBS_BALL_VELOCITY_X] = ball.Velocity.x;
+  observation[OBS_BALL_VELOCITY_Y] = ball.Velocity.y;
+  observation[OBS_BALL_STUCK] = ball.Stuck ? 1.0f : 0.0f;
+  for (unsigned int type = 0; type < POWER_UP_TYPES; ++type)
+    observation[OBS_POWER_UPS + type] = 0.0f;
+  for (const PowerUp &powerUp : game.PowerUps)
+  {
+    float &left = observation[OBS_POWER_UPS + powerUp.Type];
+    if (powerUp.Activated && powerUp.Duration > left)
+      left = powerUp.Duration;
+  }
+
+  const std::vector<uint8_t> &destroyed = game.Levels[game.CurrentLevel].Destroyed;
+  std::memcpy(&bricks[static_cast<size_t>(session) * brickBytes], destroyed.data(), brickBytes);
+}
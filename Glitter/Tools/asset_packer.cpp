@@ -0,0 +1,83 @@
+// Offline asset packer: bundles shaders, decoded textures and compiled levels into
+// one asset pack that ResourceManager::MountPack memory-maps at startup.
+//
+//     BreakoutPacker <output.pak> <asset root> <asset>...
+//
+// Assets are named by their path relative to the asset root, the same names the
+// game passes to ResourceManager (e.g. "Textures/block.png").
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "asset_pack.hpp"
+#include "level_format.hpp"
+#include "mapped_file.hpp"
+#include "stb_image.h"
+
+static bool hasExtension(const std::string &name, const char *extension)
+{
+  size_t length = std::strlen(extension);
+  return name.size() >= length && name.compare(name.size() - length, length, extension) == 0;
+}
+
+static bool packAsset(AssetPackWriter &writer, const std::string &root, const std::string &name)
+{
+  std::string path = root + "/" + name;
+  if (hasExtension(name, ".png") || hasExtension(name, ".jpg"))
+  {
+    // decoded exactly like ResourceManager does, texels are uploaded as stored
+    int width, height, nrChannels;
+    unsigned char *data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
+    if (!data)
+    {
+      std::cerr << "ERROR::ASSET_PACKER::Failed to decode texture: " << path << std::endl;
+      return false;
+    }
+    bool added = writer.Add(name, ASSET_TEXTURE, data, static_cast<size_t>(width) * height * nrChannels,
+                            width, height, nrChannels);
+    stbi_image_free(data);
+    return added;
+  }
+
+  MappedFile source;
+  if (!source.Open(path.c_str()))
+  {
+    std::cerr << "ERROR::ASSET_PACKER::Failed to read asset: " << path << std::endl;
+    return false;
+  }
+  if (hasExtension(name, ".lvl"))
+  {
+    LevelTiles tiles;
+    if (!ParseLevelText(reinterpret_cast<const char *>(source.Data()), source.Size(), tiles))
+    {
+      std::cerr << "ERROR::ASSET_PACKER::No tiles in level file: " << path << std::endl;
+      return false;
+    }
+    std::vector<unsigned char> compiled;
+    CompileLevel(tiles, compiled);
+    return writer.Add(name, ASSET_LEVEL, compiled.data(), compiled.size());
+  }
+  // everything else is shader source
+  return writer.Add(name, ASSET_SHADER, source.Data(), source.Size());
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc < 4)
+  {
+    std::cout << "Usage: " << argv[0] << " <output.pak> <asset root> <asset>..." << std::endl;
+    return -1;
+  }
+
+  AssetPackWriter writer;
+  for (int i = 3; i < argc; ++i)
+  {
+    if (!packAsset(writer, argv[2], argv[i]))
+      return -1;
+  }
+  if (!writer.Write(argv[1]))
+    return -1;
+
+  std::cout << "Packed " << argc - 3 << " assets into " << argv[1] << std::endl;
+  return 0;
+}
@@ -0,0 +1,36 @@
+// Offline level compiler: turns a text level (.lvl) into a compiled level (.blvl)
+// that LevelTemplate::Load memory-maps and uses without parsing.
+//
+//     BreakoutLevelCompiler <input.lvl> <output.blvl>
+#include <iostream>
+
+#include "level_format.hpp"
+#include "mapped_file.hpp"
+
+int main(int argc, char *argv[])
+{
+  if (argc != 3)
+  {
+    std::cout << "Usage: " << argv[0] << " <input.lvl> <output.blvl>" << std::endl;
+    return -1;
+  }
+
+  MappedFile source;
+  if (!source.Open(argv[1]))
+  {
+    std::cerr << "ERROR::LEVEL_COMPILER::Failed to read level file: " << argv[1] << std::endl;
+    return -1;
+  }
+  LevelTiles tiles;
+  if (!ParseLevelText(reinterpret_cast<const char *>(source.Data()), source.Size(), tiles))
+  {
+    std::cerr << "ERROR::LEVEL_COMPILER::No tiles in level file: " << argv[1] << std::endl;
+    return -1;
+  }
+  if (!WriteCompiledLevel(argv[2], tiles))
+    return -1;
+
+  std::cout << argv[1] << " -> " << argv[2] << " (" << tiles.Width << "x" << tiles.Height
+            << " tiles)" << std::endl;
+  return 0;
+}